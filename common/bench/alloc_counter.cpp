@@ -0,0 +1,85 @@
+// Замена malloc/calloc/realloc/free и выравнивающих вариантов со счётчиком
+// вызовов и байт. Подключается ровно в один исполняемый файл бенчмарка.
+//
+// Считается уровень malloc, а не operator new: стандартный operator new
+// сам вызывает malloc и попадает сюда же, а аллокаторы, берущие память у
+// malloc напрямую (пулы homework-3), без этого в счётчик не входили бы.
+// Реальное выделение — через точки входа glibc __libc_*, поэтому только
+// glibc.
+#include "bench.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+
+#ifndef __GLIBC__
+#error "alloc_counter.cpp forwards to glibc's __libc_malloc family"
+#endif
+
+extern "C" {
+void* __libc_malloc(std::size_t n);
+void* __libc_calloc(std::size_t count, std::size_t n);
+void* __libc_realloc(void* p, std::size_t n);
+void* __libc_memalign(std::size_t alignment, std::size_t n);
+void __libc_free(void* p);
+}
+
+namespace {
+
+std::atomic<std::uint64_t> g_calls{0};
+std::atomic<std::uint64_t> g_bytes{0};
+
+void count(std::size_t n) noexcept {
+    g_calls.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(n, std::memory_order_relaxed);
+}
+
+} // namespace
+
+namespace bench {
+
+std::uint64_t alloc_calls() { return g_calls.load(std::memory_order_relaxed); }
+std::uint64_t alloc_bytes() { return g_bytes.load(std::memory_order_relaxed); }
+
+} // namespace bench
+
+extern "C" {
+
+void* malloc(std::size_t n) noexcept {
+    count(n);
+    return __libc_malloc(n);
+}
+
+void* calloc(std::size_t items, std::size_t n) noexcept {
+    count(items * n);
+    return __libc_calloc(items, n);
+}
+
+// realloc считается выделением n байт, даже если блок расширился на месте
+void* realloc(void* p, std::size_t n) noexcept {
+    count(n);
+    return __libc_realloc(p, n);
+}
+
+void* memalign(std::size_t alignment, std::size_t n) noexcept {
+    count(n);
+    return __libc_memalign(alignment, n);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t n) noexcept {
+    count(n);
+    return __libc_memalign(alignment, n);
+}
+
+int posix_memalign(void** out, std::size_t alignment, std::size_t n) noexcept {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+    count(n);
+    void* p = __libc_memalign(alignment, n);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void free(void* p) noexcept { __libc_free(p); }
+
+} // extern "C"
@@ -0,0 +1,236 @@
+#pragma once
+// Общий каркас микробенчмарков для домашних заданий.
+//
+// Runner::run(name, size, ops, setup, body): setup() готовит состояние вне
+// замера, body(state) выполняет ops операций под таймером. Сначала
+// --warmup прогонов без учёта, затем --reps замеров; в отчёт идут медиана,
+// MAD (медиана абсолютных отклонений) и минимум нс на операцию, а также
+// число выделений памяти и байт на операцию. Счётчик (alloc_counter.cpp)
+// стоит на уровне malloc: в него входят и operator new, и прямые вызовы
+// malloc/aligned_alloc. Выделения в setup() не считаются.
+//
+// Итог печатается таблицей и, с --json FILE, пишется в JSON по результату
+// на строку, чтобы файлы разных коммитов можно было сравнивать diff'ом.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// alloc_counter.cpp
+std::uint64_t alloc_calls();
+std::uint64_t alloc_bytes();
+
+// Не даёт компилятору выбросить вычисление value
+template <class T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Options {
+    int warmup = 1;
+    int reps = 5;
+    std::string json;     // пусто — без JSON
+    std::string filter;   // подстрока имени бенчмарка
+    std::string label;    // метка прогона в JSON, например хеш коммита
+    std::uint64_t max_size = 0;  // 0 — предел по умолчанию набора
+};
+
+inline void print_options_usage() {
+    std::cout <<
+        "  --warmup N       untimed runs before measuring (default 1)\n"
+        "  --reps N         measured runs (default 5)\n"
+        "  --filter STR     only benchmarks whose name contains STR\n"
+        "  --max-size N     largest size parameter to run\n"
+        "  --json FILE      write results as JSON\n"
+        "  --label STR      label stored in the JSON (e.g. commit hash)\n";
+}
+
+// usage печатает строку Usage и опции набора; общие опции добавляются сами
+inline bool parse_options(int argc, char** argv, Options& o, void (*usage)(const char*)) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (key == "-h" || key == "--help") {
+            usage(argv[0]);
+            print_options_usage();
+            return false;
+        } else if (key == "--warmup") {
+            o.warmup = std::stoi(need("--warmup"));
+        } else if (key == "--reps") {
+            o.reps = std::stoi(need("--reps"));
+        } else if (key == "--filter") {
+            o.filter = need("--filter");
+        } else if (key == "--max-size") {
+            o.max_size = static_cast<std::uint64_t>(std::stod(need("--max-size")));
+        } else if (key == "--json") {
+            o.json = need("--json");
+        } else if (key == "--label") {
+            o.label = need("--label");
+        } else {
+            std::cerr << "Unknown option: " << key << "\n";
+            usage(argv[0]);
+            print_options_usage();
+            std::exit(2);
+        }
+    }
+    if (o.warmup < 0 || o.reps < 1) {
+        std::cerr << "--warmup must be >= 0 and --reps >= 1\n";
+        std::exit(2);
+    }
+    return true;
+}
+
+struct Result {
+    std::string name;
+    std::uint64_t size = 0;
+    std::uint64_t ops = 0;
+    double median_ns = 0;  // всё — на операцию
+    double mad_ns = 0;
+    double min_ns = 0;
+    double allocs = 0;
+    double bytes = 0;
+};
+
+inline double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    std::size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+class Runner {
+public:
+    Runner(std::string suite, Options options) : suite_(std::move(suite)), o_(std::move(options)) {}
+
+    const Options& options() const { return o_; }
+
+    bool enabled(const std::string& name) const {
+        return o_.filter.empty() || name.find(o_.filter) != std::string::npos;
+    }
+
+    template <class Setup, class Body>
+    void run(const std::string& name, std::uint64_t size, std::uint64_t ops, Setup setup, Body body) {
+        if (!enabled(name) || ops == 0) return;
+        if (!header_) {
+            print_header();
+            header_ = true;
+        }
+
+        for (int i = 0; i < o_.warmup; i++) {
+            auto state = setup();
+            body(state);
+        }
+
+        std::vector<double> ns;
+        std::uint64_t calls = 0, bytes = 0;
+        for (int i = 0; i < o_.reps; i++) {
+            auto state = setup();
+            std::uint64_t calls0 = alloc_calls(), bytes0 = alloc_bytes();
+            auto start = std::chrono::steady_clock::now();
+            body(state);
+            auto stop = std::chrono::steady_clock::now();
+            calls += alloc_calls() - calls0;
+            bytes += alloc_bytes() - bytes0;
+            ns.push_back(std::chrono::duration<double, std::nano>(stop - start).count() / double(ops));
+        }
+
+        Result r;
+        r.name = name;
+        r.size = size;
+        r.ops = ops;
+        r.median_ns = median(ns);
+        std::vector<double> dev;
+        for (double x : ns) dev.push_back(std::fabs(x - r.median_ns));
+        r.mad_ns = median(dev);
+        r.min_ns = *std::min_element(ns.begin(), ns.end());
+        r.allocs = double(calls) / double(ops) / o_.reps;
+        r.bytes = double(bytes) / double(ops) / o_.reps;
+        print_row(r);
+        results_.push_back(r);
+    }
+
+    // Пишет JSON, если задан; false — файл не записался
+    bool finish() const {
+        if (o_.json.empty()) return true;
+        std::ofstream out(o_.json);
+        out << "{\n"
+            << "  \"suite\": \"" << escape(suite_) << "\",\n"
+            << "  \"label\": \"" << escape(o_.label) << "\",\n"
+#ifdef __VERSION__
+            << "  \"compiler\": \"" << escape(__VERSION__) << "\",\n"
+#endif
+#ifdef NDEBUG
+            << "  \"assertions\": false,\n"
+#else
+            << "  \"assertions\": true,\n"
+#endif
+            << "  \"warmup\": " << o_.warmup << ",\n"
+            << "  \"reps\": " << o_.reps << ",\n"
+            << "  \"results\": [\n";
+        for (std::size_t i = 0; i < results_.size(); i++) {
+            const Result& r = results_[i];
+            out << "    {\"name\": \"" << escape(r.name) << "\", \"size\": " << r.size << ", \"ops\": " << r.ops
+                << ", \"median_ns\": " << number(r.median_ns) << ", \"mad_ns\": " << number(r.mad_ns)
+                << ", \"min_ns\": " << number(r.min_ns) << ", \"allocs_per_op\": " << number(r.allocs)
+                << ", \"bytes_per_op\": " << number(r.bytes) << "}" << (i + 1 < results_.size() ? "," : "")
+                << "\n";
+        }
+        out << "  ]\n}\n";
+        out.close();
+        if (!out) {
+            std::cerr << "Cannot write " << o_.json << "\n";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static std::string escape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20) out += c;
+        }
+        return out;
+    }
+
+    static std::string number(double x) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.4g", x);
+        return buf;
+    }
+
+    static void print_header() {
+        std::cout << std::left << std::setw(28) << "benchmark" << std::right << std::setw(11) << "size"
+                  << std::setw(11) << "ops" << std::setw(11) << "ns/op" << std::setw(9) << "mad" << std::setw(11)
+                  << "min" << std::setw(10) << "allocs/op" << std::setw(10) << "bytes/op" << "\n";
+    }
+
+    static void print_row(const Result& r) {
+        std::cout << std::left << std::setw(28) << r.name << std::right << std::setw(11) << r.size
+                  << std::setw(11) << r.ops << std::setw(11) << number(r.median_ns) << std::setw(9)
+                  << number(r.mad_ns) << std::setw(11) << number(r.min_ns) << std::setw(10) << number(r.allocs)
+                  << std::setw(10) << number(r.bytes) << std::endl;
+    }
+
+    std::string suite_;
+    Options o_;
+    std::vector<Result> results_;
+    bool header_ = false;
+};
+
+} // namespace bench
@@ -0,0 +1,97 @@
+// Масштабирование счётчика на горячем пути: T потоков делают по N
+// striped_counter_add. Одна полоса — все потоки бьют в одно атомарное
+// слово (как std::atomic<long long>), по полосе на поток — каждый пишет в
+// свою кеш-линию.
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "striped_counter.hpp"
+
+typedef struct {
+    StripedCounter* counter;
+    long long iterations;
+    pthread_barrier_t* start;
+    double begin;  // заполняет сам поток: начало и конец своих add
+    double end;
+} Worker;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void* run_worker(void* arg) {
+    Worker* w = (Worker*)arg;
+    long long i;
+    pthread_barrier_wait(w->start);
+    w->begin = now_seconds();
+    for (i = 0; i < w->iterations; i++) striped_counter_add(w->counter, 1);
+    w->end = now_seconds();
+    return NULL;
+}
+
+// Миллионы add в секунду; -1, если сумма не сошлась. Время — от самого
+// раннего начала до самого позднего конца по часам потоков: главный поток
+// может проснуться после барьера, когда рабочие уже закончили.
+static double measure(int stripes, int threads, long long iterations) {
+    StripedCounter* counter = striped_counter_create(stripes);
+    pthread_t* ids = malloc(sizeof(pthread_t) * (size_t)threads);
+    Worker* workers = malloc(sizeof(Worker) * (size_t)threads);
+    pthread_barrier_t start;
+    double begin, end, seconds;
+    long long total;
+    int t;
+
+    pthread_barrier_init(&start, NULL, (unsigned)threads + 1);
+    for (t = 0; t < threads; t++) {
+        workers[t].counter = counter;
+        workers[t].iterations = iterations;
+        workers[t].start = &start;
+        pthread_create(&ids[t], NULL, run_worker, &workers[t]);
+    }
+    pthread_barrier_wait(&start);
+    for (t = 0; t < threads; t++) pthread_join(ids[t], NULL);
+    begin = workers[0].begin;
+    end = workers[0].end;
+    for (t = 1; t < threads; t++) {
+        if (workers[t].begin < begin) begin = workers[t].begin;
+        if (workers[t].end > end) end = workers[t].end;
+    }
+    seconds = end - begin;
+
+    total = striped_counter_snapshot_reset(counter);
+    pthread_barrier_destroy(&start);
+    free(workers);
+    free(ids);
+    striped_counter_destroy(counter);
+    if (total != iterations * threads) return -1;
+    return (double)total / seconds / 1e6;
+}
+
+int main(int argc, char** argv) {
+    static const int kThreads[] = {1, 2, 4, 8, 16, 32, 64};
+    long long iterations = argc > 1 ? atoll(argv[1]) : 2000000;
+    size_t i;
+
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [adds per thread, default 2000000]\n", argv[0]);
+        return 2;
+    }
+    printf("%7s %14s %14s %8s\n", "threads", "single Madd/s", "striped Madd/s", "speedup");
+    for (i = 0; i < sizeof(kThreads) / sizeof(kThreads[0]); i++) {
+        int threads = kThreads[i];
+        double single = measure(1, threads, iterations);
+        double striped = measure(threads, threads, iterations);
+        if (single < 0 || striped < 0) {
+            fprintf(stderr, "Lost updates at %d threads\n", threads);
+            return 1;
+        }
+        printf("%7d %14.1f %14.1f %8.2f\n", threads, single, striped, striped / single);
+    }
+    return 0;
+}
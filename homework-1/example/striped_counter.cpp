@@ -0,0 +1,117 @@
+#include "striped_counter.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+
+namespace {
+
+const std::size_t kCacheLine = 64;
+
+// Полоса занимает кеш-линию целиком
+struct Stripe {
+    std::atomic<long long> value;
+    char pad[kCacheLine - sizeof(std::atomic<long long>)];
+};
+
+// Номер потока, выдаётся по кругу при первом обращении: соседние потоки
+// попадают в разные полосы
+unsigned thread_slot() {
+    static std::atomic<unsigned> next(0);
+    static thread_local unsigned slot = next.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+class StripedCounterImpl {
+public:
+    explicit StripedCounterImpl(std::size_t stripes) : mask_(stripes - 1) {
+        // new в C++11 не выравнивает больше alignof(max_align_t): линии
+        // выравниваются вручную
+        raw_ = new (std::nothrow) unsigned char[stripes * sizeof(Stripe) + kCacheLine];
+        if (!raw_) return;
+        std::uintptr_t p = reinterpret_cast<std::uintptr_t>(raw_);
+        stripes_ = reinterpret_cast<Stripe*>((p + kCacheLine - 1) & ~std::uintptr_t(kCacheLine - 1));
+        for (std::size_t i = 0; i < stripes; i++) new (&stripes_[i].value) std::atomic<long long>(0);
+    }
+
+    ~StripedCounterImpl() { delete[] raw_; }
+
+    void add(long long delta) {
+        std::size_t i = mask_ == 0 ? 0 : thread_slot() & mask_;
+        stripes_[i].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    long long get() const {
+        long long sum = 0;
+        for (std::size_t i = 0; i <= mask_; i++) sum += stripes_[i].value.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    long long snapshot_reset() {
+        long long sum = 0;
+        for (std::size_t i = 0; i <= mask_; i++) sum += stripes_[i].value.exchange(0, std::memory_order_relaxed);
+        return sum;
+    }
+
+    int stripes() const { return int(mask_ + 1); }
+    bool valid() const { return raw_ != 0; }
+
+private:
+    StripedCounterImpl(const StripedCounterImpl&);
+    StripedCounterImpl& operator=(const StripedCounterImpl&);
+
+    unsigned char* raw_;
+    Stripe* stripes_ = nullptr;
+    std::size_t mask_;
+};
+
+} // namespace
+
+struct StripedCounter {
+    StripedCounterImpl* impl;
+};
+
+extern "C" {
+
+StripedCounter* striped_counter_create(int stripes) {
+    std::size_t want = stripes > 0 ? std::size_t(stripes) : std::size_t(std::thread::hardware_concurrency());
+    const std::size_t kMaxStripes = 4096;
+    std::size_t n = 1;
+    while (n < want && n < kMaxStripes) n <<= 1;
+
+    StripedCounter* counter = new (std::nothrow) StripedCounter;
+    if (!counter) return 0;
+    counter->impl = new (std::nothrow) StripedCounterImpl(n);
+    if (!counter->impl || !counter->impl->valid()) {
+        delete counter->impl;
+        delete counter;
+        return 0;
+    }
+    return counter;
+}
+
+void striped_counter_destroy(StripedCounter* counter) {
+    if (!counter) return;
+    delete counter->impl;
+    delete counter;
+}
+
+void striped_counter_add(StripedCounter* counter, long long delta) {
+    if (counter) counter->impl->add(delta);
+}
+
+long long striped_counter_get(const StripedCounter* counter) {
+    return counter ? counter->impl->get() : 0;
+}
+
+long long striped_counter_snapshot_reset(StripedCounter* counter) {
+    return counter ? counter->impl->snapshot_reset() : 0;
+}
+
+int striped_counter_stripes(const StripedCounter* counter) {
+    return counter ? counter->impl->stripes() : 0;
+}
+
+} // extern "C"
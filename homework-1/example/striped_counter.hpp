@@ -0,0 +1,36 @@
+#ifndef STRIPED_COUNTER_HPP
+#define STRIPED_COUNTER_HPP
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Счётчик для горячего пути многих потоков. Значение разложено по
+// полосам (stripes), каждая в своей кеш-линии; поток пишет в свою
+// полосу, поэтому одновременные add не гоняют одну линию между ядрами.
+// Чтение суммирует полосы.
+typedef struct StripedCounter StripedCounter;
+
+// stripes — число полос, округляется вверх до степени двойки;
+// 0 — по числу процессоров; 1 — одно общее атомарное слово без полос
+StripedCounter* striped_counter_create(int stripes);
+void striped_counter_destroy(StripedCounter* counter);
+
+void striped_counter_add(StripedCounter* counter, long long delta);
+
+// Сумма полос. Полосы читаются по очереди без общей блокировки: при
+// параллельных add результат — одно из промежуточных значений, но
+// ни один add не теряется.
+long long striped_counter_get(const StripedCounter* counter);
+
+// Возвращает сумму и обнуляет полосы. Каждый add попадает ровно в один
+// снимок: этот или следующий.
+long long striped_counter_snapshot_reset(StripedCounter* counter);
+
+int striped_counter_stripes(const StripedCounter* counter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STRIPED_COUNTER_HPP
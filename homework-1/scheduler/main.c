@@ -0,0 +1,26 @@
+#include <stdio.h>
+
+#include "scheduler.h"
+
+int main(void) {
+    Scheduler* s = scheduler_create(SCHEDULER_ENGINE_HEAP);
+    SchedulerTask ready[8];
+    uint64_t now;
+    size_t i, n;
+
+    scheduler_add(s, 1, "blink", 100, 0);
+    scheduler_add(s, 2, "poll", 250, 50);
+    scheduler_add(s, 3, "once", 0, 120);
+
+    for (now = 0; now <= 500; now += 50) {
+        scheduler_tick(s, now);
+        n = scheduler_pop_ready(s, ready, sizeof(ready) / sizeof(ready[0]));
+        for (i = 0; i < n; i++)
+            printf("t=%3llu run %s (scheduled %llu)\n", (unsigned long long)now, ready[i].name,
+                   (unsigned long long)ready[i].next_run_ms);
+    }
+    printf("tasks left: %zu\n", scheduler_count(s));
+
+    scheduler_destroy(s);
+    return 0;
+}
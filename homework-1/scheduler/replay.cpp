@@ -0,0 +1,342 @@
+// Запись и воспроизведение трасс планировщика.
+//
+//   scheduler_replay --generate --tasks N --out FILE
+//     прогоняет детерминированную нагрузку через C API (engine heap) с
+//     включённой записью трассы;
+//   scheduler_replay FILE [--engines heap,linear] [--expect CHECKSUM]
+//     подаёт те же вызовы каждому engine по очереди на каждой записи,
+//     сверяет статусы и счётчики с записанными, а выданные pop_ready
+//     задачи — между engine поле в поле и, с --expect, с контрольной
+//     суммой, записанной для трассы раньше; печатает перцентили времени
+//     tick и размеров пакетов готовых задач.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "scheduler.h"
+#include "trace.hpp"
+
+struct Args {
+    bool generate = false;
+    std::string trace;
+    uint32_t tasks = 1000;
+    uint32_t ticks = 10000;  // шаг 1 мс; меньше 10^4 — p999 совпадает с max
+    uint64_t seed = 1;
+    std::string expect;  // ожидаемая контрольная сумма выданных задач, hex
+    std::vector<SchedulerEngine> engines{SCHEDULER_ENGINE_HEAP, SCHEDULER_ENGINE_LINEAR};
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " --generate --out FILE [options]\n"
+        "       " << prog << " FILE [--engines LIST] [--expect CHECKSUM]\n"
+        "Generate options:\n"
+        "  --tasks N        tasks added before the first tick (default 1000)\n"
+        "  --ticks N        ticks, 1 ms apart (default 10000)\n"
+        "  --seed N         workload seed (default 1)\n"
+        "Replay options:\n"
+        "  --engines LIST   comma-separated: heap, linear (default heap,linear)\n"
+        "  --expect HEX     fail unless the popped-task checksum equals HEX\n";
+}
+
+static const char* engine_name(SchedulerEngine e) {
+    return e == SCHEDULER_ENGINE_HEAP ? "heap" : "linear";
+}
+
+static bool parse_engine(const std::string& s, SchedulerEngine& e) {
+    if (s == "heap") e = SCHEDULER_ENGINE_HEAP;
+    else if (s == "linear") e = SCHEDULER_ENGINE_LINEAR;
+    else return false;
+    return true;
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (key == "-h" || key == "--help") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--generate") {
+            a.generate = true;
+        } else if (key == "--out") {
+            a.trace = need("--out");
+        } else if (key == "--tasks") {
+            a.tasks = uint32_t(std::stoul(need("--tasks")));
+        } else if (key == "--ticks") {
+            a.ticks = uint32_t(std::stoul(need("--ticks")));
+        } else if (key == "--seed") {
+            a.seed = std::stoull(need("--seed"));
+        } else if (key == "--expect") {
+            a.expect = need("--expect");
+        } else if (key == "--engines") {
+            std::stringstream list(need("--engines"));
+            std::string item;
+            a.engines.clear();
+            while (std::getline(list, item, ',')) {
+                SchedulerEngine e;
+                if (!parse_engine(item, e)) {
+                    std::cerr << "Unknown engine: " << item << "\n";
+                    std::exit(2);
+                }
+                a.engines.push_back(e);
+            }
+        } else if (!key.empty() && key[0] != '-' && a.trace.empty()) {
+            a.trace = key;
+        } else {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        }
+    }
+    if (a.trace.empty() || a.engines.empty() || a.tasks == 0) {
+        print_usage(argv[0]);
+        std::exit(2);
+    }
+    return true;
+}
+
+// ---- генерация ----
+
+// Нагрузка: a.tasks задач (часть одноразовых), затем a.ticks тиков по 1 мс;
+// после каждого tick очередь готовых выбирается пакетами по 64, часть задач
+// снимается и заменяется новыми. Изредка — заведомо ошибочные вызовы, чтобы
+// в трассе были и статусы ошибок.
+static int generate(const Args& a) {
+    const uint64_t kPeriods[] = {0, 100, 250, 500, 1000, 5000};
+    const size_t kBatch = 64;
+
+    Scheduler* s = scheduler_create(SCHEDULER_ENGINE_HEAP);
+    if (!s) {
+        std::cerr << "Out of memory\n";
+        return 1;
+    }
+    SchedulerStatus st = scheduler_trace_start(s, a.trace.c_str());
+    if (st != SCHEDULER_OK) {
+        std::cerr << (st == SCHEDULER_ERR_INVALID ? "Tracing is not compiled in (SCHEDULER_TRACE)\n"
+                                                  : "Cannot write " + a.trace + "\n");
+        scheduler_destroy(s);
+        return 1;
+    }
+
+    std::mt19937_64 rng(a.seed);
+    std::vector<uint32_t> live;
+    uint32_t next_id = 1;
+    auto add = [&](uint64_t now) {
+        uint64_t period = kPeriods[rng() % (sizeof(kPeriods) / sizeof(kPeriods[0]))];
+        uint64_t first = now + 1 + rng() % (period ? period : a.ticks);
+        std::string name = "task-" + std::to_string(next_id);
+        if (scheduler_add(s, next_id, name.c_str(), period, first) == SCHEDULER_OK) live.push_back(next_id);
+        next_id++;
+    };
+
+    for (uint32_t i = 0; i < a.tasks; i++) add(0);
+
+    uint32_t churn = std::max<uint32_t>(1, a.tasks / 10000);
+    std::vector<SchedulerTask> batch(kBatch);
+    for (uint64_t now = 1; now <= a.ticks; now++) {
+        scheduler_tick(s, now);
+        while (scheduler_pop_ready(s, batch.data(), batch.size()) == batch.size()) {
+        }
+        for (uint32_t c = 0; c < churn && !live.empty(); c++) {
+            size_t i = rng() % live.size();
+            scheduler_remove(s, live[i]);  // одноразовая могла уже уйти: NOT_FOUND
+            live[i] = live.back();
+            live.pop_back();
+            add(now);
+        }
+        if (now % 100 == 0) {
+            scheduler_add(s, 1, "dup", 1, now);  // EXISTS, пока задача 1 жива
+            scheduler_remove(s, next_id + 1);    // NOT_FOUND
+        }
+    }
+
+    st = scheduler_trace_stop(s);
+    scheduler_destroy(s);
+    if (st != SCHEDULER_OK) {
+        std::cerr << "Cannot write " << a.trace << "\n";
+        return 1;
+    }
+    std::cerr << "trace: " << a.trace << ", " << a.tasks << " tasks, " << a.ticks << " ticks\n";
+    return 0;
+}
+
+// ---- воспроизведение ----
+
+struct Series {
+    std::vector<uint32_t> tick_ns;
+    std::vector<uint32_t> batch;  // число ставших готовыми за tick
+};
+
+// p999 различим с максимумом только от 10^4 тиков
+const size_t kP999Samples = 10000;
+
+// Ближайший ранг; v сортируется
+static uint32_t percentile(std::vector<uint32_t>& v, double p) {
+    if (v.empty()) return 0;
+    size_t rank = size_t(p * double(v.size()));
+    if (rank >= v.size()) rank = v.size() - 1;
+    std::nth_element(v.begin(), v.begin() + std::ptrdiff_t(rank), v.end());
+    return v[rank];
+}
+
+static void print_row(const std::string& name, Series& s) {
+    std::string p999 = s.tick_ns.size() >= kP999Samples ? std::to_string(percentile(s.tick_ns, 0.999)) : "-";
+    std::cout << std::left << std::setw(16) << name << std::right << std::setw(9) << s.tick_ns.size()
+              << std::setw(10) << percentile(s.tick_ns, 0.50) << std::setw(10) << percentile(s.tick_ns, 0.99)
+              << std::setw(10) << p999 << std::setw(10) << percentile(s.tick_ns, 1.0)
+              << std::setw(8) << percentile(s.batch, 0.50) << std::setw(8) << percentile(s.batch, 0.99)
+              << std::setw(8) << percentile(s.batch, 1.0) << "\n";
+}
+
+static bool same_task(const SchedulerTask& x, const SchedulerTask& y) {
+    return x.id == y.id && std::memcmp(x.name, y.name, sizeof(x.name)) == 0 && x.period_ms == y.period_ms &&
+           x.next_run_ms == y.next_run_ms;
+}
+
+static int replay(const Args& a) {
+    trace::Reader reader;
+    if (!reader.open(a.trace.c_str())) {
+        std::cerr << "Not a scheduler trace: " << a.trace << "\n";
+        return 1;
+    }
+
+    struct Run {
+        SchedulerEngine engine;
+        Scheduler* s;
+        Series series;
+        std::vector<SchedulerTask> out;
+    };
+    std::vector<Run> runs;
+    for (SchedulerEngine e : a.engines) {
+        Run r;
+        r.engine = e;
+        r.s = scheduler_create(e);
+        if (!r.s) {
+            std::cerr << "Out of memory\n";
+            return 1;
+        }
+        runs.push_back(std::move(r));
+    }
+
+    Series recorded;
+    uint64_t records = 0, popped = 0, checksum = 1469598103934665603ULL;
+    size_t mismatches = 0;
+    auto mismatch = [&](const std::string& what) {
+        if (mismatches++ < 10) std::cerr << "record " << records << ": " << what << "\n";
+    };
+
+    trace::Record rec;
+    while (reader.next(rec)) {
+        records++;
+        switch (rec.op) {
+        case trace::Op::Add:
+        case trace::Op::Remove:
+            for (Run& r : runs) {
+                SchedulerStatus st = rec.op == trace::Op::Add
+                                         ? scheduler_add(r.s, rec.id, rec.name.c_str(), rec.arg, rec.first_run)
+                                         : scheduler_remove(r.s, rec.id);
+                if (uint32_t(st) != rec.result)
+                    mismatch(std::string(engine_name(r.engine)) + ": status " + std::to_string(st) +
+                             ", recorded " + std::to_string(rec.result));
+            }
+            break;
+        case trace::Op::Tick:
+            recorded.tick_ns.push_back(rec.ns);
+            recorded.batch.push_back(rec.result);
+            for (Run& r : runs) {
+                auto start = std::chrono::steady_clock::now();
+                size_t n = scheduler_tick(r.s, rec.arg);
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                               start).count();
+                r.series.tick_ns.push_back(uint32_t(std::min<long long>(ns, 0xffffffffLL)));
+                r.series.batch.push_back(uint32_t(n));
+                if (n != rec.result)
+                    mismatch(std::string(engine_name(r.engine)) + ": tick " + std::to_string(rec.arg) + " ready " +
+                             std::to_string(n) + ", recorded " + std::to_string(rec.result));
+            }
+            break;
+        case trace::Op::Pop: {
+            size_t got = 0;
+            for (size_t i = 0; i < runs.size(); i++) {
+                Run& r = runs[i];
+                r.out.resize(rec.arg);
+                size_t n = scheduler_pop_ready(r.s, r.out.data(), r.out.size());
+                r.out.resize(n);
+                if (n != rec.result)
+                    mismatch(std::string(engine_name(r.engine)) + ": pop " + std::to_string(n) + ", recorded " +
+                             std::to_string(rec.result));
+                if (i == 0) {
+                    got = n;
+                    continue;
+                }
+                bool same = n == runs[0].out.size();
+                for (size_t k = 0; same && k < n; k++) same = same_task(r.out[k], runs[0].out[k]);
+                if (!same)
+                    mismatch(std::string(engine_name(r.engine)) + ": popped tasks differ from " +
+                             engine_name(runs[0].engine));
+            }
+            popped += got;
+            // FNV-1a по выданным задачам: одно число для сравнения прогонов
+            for (size_t k = 0; k < got; k++) {
+                const SchedulerTask& t = runs[0].out[k];
+                uint64_t fields[3] = {t.id, t.period_ms, t.next_run_ms};
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(fields);
+                for (size_t b = 0; b < sizeof(fields); b++) checksum = (checksum ^ p[b]) * 1099511628211ULL;
+                for (size_t b = 0; b < sizeof(t.name); b++)
+                    checksum = (checksum ^ (unsigned char)t.name[b]) * 1099511628211ULL;
+            }
+            break;
+        }
+        }
+    }
+    if (reader.bad()) {
+        std::cerr << "Truncated or corrupt record after " << records << " records\n";
+        mismatches++;
+    }
+
+    std::cout << "trace: " << a.trace << ", " << records << " records, recorded by "
+              << engine_name(SchedulerEngine(reader.engine())) << "\n";
+    std::cout << std::left << std::setw(16) << "engine" << std::right << std::setw(9) << "ticks" << std::setw(10)
+              << "p50_ns" << std::setw(10) << "p99_ns" << std::setw(10) << "p999_ns" << std::setw(10) << "max_ns"
+              << std::setw(8) << "b_p50" << std::setw(8) << "b_p99" << std::setw(8) << "b_max" << "\n";
+    print_row("recorded", recorded);
+    for (Run& r : runs) {
+        print_row(engine_name(r.engine), r.series);
+        scheduler_destroy(r.s);
+    }
+    std::ostringstream hex;
+    hex << std::hex << checksum;
+    std::cout << "popped " << popped << " tasks, checksum " << hex.str() << "\n";
+    if (!a.expect.empty() && a.expect != hex.str()) {
+        std::cout << "checksum " << hex.str() << ", expected " << a.expect << "\n";
+        mismatches++;
+    }
+    if (mismatches > 0) {
+        std::cout << "MISMATCH: " << mismatches << " differences\n";
+        return 1;
+    }
+    std::cout << "outputs identical across engines and the recording\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+    return a.generate ? generate(a) : replay(a);
+}
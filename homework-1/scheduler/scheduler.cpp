@@ -0,0 +1,386 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#ifdef SCHEDULER_TRACE
+#include <chrono>
+
+#include "trace.hpp"
+#endif
+
+namespace {
+
+SchedulerTask make_task(uint32_t id, const char* name, uint64_t period_ms, uint64_t first_run_ms) {
+    SchedulerTask t;
+    std::memset(&t, 0, sizeof(t));
+    t.id = id;
+    if (name) std::strncpy(t.name, name, SCHEDULER_NAME_LEN - 1);
+    t.period_ms = period_ms;
+    t.next_run_ms = first_run_ms;
+    return t;
+}
+
+// Порядок постановки в очередь готовых
+bool runs_before(const SchedulerTask& a, const SchedulerTask& b) {
+    return a.next_run_ms != b.next_run_ms ? a.next_run_ms < b.next_run_ms : a.id < b.id;
+}
+
+// Первый запуск после now для периодической задачи
+uint64_t next_after(const SchedulerTask& t, uint64_t now) {
+    return t.next_run_ms + t.period_ms * ((now - t.next_run_ms) / t.period_ms + 1);
+}
+
+class Engine {
+public:
+    virtual ~Engine() = default;
+
+    virtual bool add(const SchedulerTask& task) = 0;
+    virtual bool remove(uint32_t id) = 0;
+    virtual const SchedulerTask* find(uint32_t id) const = 0;
+    virtual size_t count() const = 0;
+
+    // Готовые к now задачи в ready по порядку runs_before; периодические
+    // переносятся, одноразовые удаляются
+    virtual size_t collect(uint64_t now, std::deque<SchedulerTask>& ready) = 0;
+};
+
+// Куча задач по (next_run_ms, id) с позициями для удаления по id
+class HeapEngine : public Engine {
+public:
+    bool add(const SchedulerTask& task) override {
+        auto ins = nodes_.emplace(task.id, Node{task, heap_.size()});
+        if (!ins.second) return false;
+        heap_.push_back(&ins.first->second);
+        sift_up(heap_.size() - 1);
+        return true;
+    }
+
+    bool remove(uint32_t id) override {
+        auto it = nodes_.find(id);
+        if (it == nodes_.end()) return false;
+        erase_at(it->second.pos);
+        nodes_.erase(it);
+        return true;
+    }
+
+    const SchedulerTask* find(uint32_t id) const override {
+        auto it = nodes_.find(id);
+        return it == nodes_.end() ? nullptr : &it->second.task;
+    }
+
+    size_t count() const override { return nodes_.size(); }
+
+    size_t collect(uint64_t now, std::deque<SchedulerTask>& ready) override {
+        size_t n = 0;
+        while (!heap_.empty() && heap_[0]->task.next_run_ms <= now) {
+            Node* top = heap_[0];
+            ready.push_back(top->task);
+            n++;
+            if (top->task.period_ms == 0) {
+                uint32_t id = top->task.id;
+                erase_at(0);
+                nodes_.erase(id);
+            } else {
+                top->task.next_run_ms = next_after(top->task, now);
+                sift_down(0);
+            }
+        }
+        return n;
+    }
+
+private:
+    struct Node {
+        SchedulerTask task;
+        size_t pos;
+    };
+
+    bool less(size_t a, size_t b) const { return runs_before(heap_[a]->task, heap_[b]->task); }
+
+    void place(size_t i, Node* node) {
+        heap_[i] = node;
+        node->pos = i;
+    }
+
+    void sift_up(size_t i) {
+        Node* node = heap_[i];
+        while (i > 0 && runs_before(node->task, heap_[(i - 1) / 2]->task)) {
+            place(i, heap_[(i - 1) / 2]);
+            i = (i - 1) / 2;
+        }
+        place(i, node);
+    }
+
+    void sift_down(size_t i) {
+        for (;;) {
+            size_t l = 2 * i + 1, r = l + 1, m = i;
+            if (l < heap_.size() && less(l, m)) m = l;
+            if (r < heap_.size() && less(r, m)) m = r;
+            if (m == i) return;
+            Node* node = heap_[i];
+            place(i, heap_[m]);
+            place(m, node);
+            i = m;
+        }
+    }
+
+    void erase_at(size_t i) {
+        Node* last = heap_.back();
+        heap_.pop_back();
+        if (i == heap_.size()) return;
+        place(i, last);
+        sift_down(i);
+        sift_up(i);
+    }
+
+    std::unordered_map<uint32_t, Node> nodes_;  // узлы unordered_map не переезжают
+    std::vector<Node*> heap_;
+};
+
+// Плотный массив задач; tick просматривает его целиком
+class LinearEngine : public Engine {
+public:
+    bool add(const SchedulerTask& task) override {
+        if (!index_.emplace(task.id, tasks_.size()).second) return false;
+        tasks_.push_back(task);
+        return true;
+    }
+
+    bool remove(uint32_t id) override {
+        auto it = index_.find(id);
+        if (it == index_.end()) return false;
+        erase_at(it->second);
+        return true;
+    }
+
+    const SchedulerTask* find(uint32_t id) const override {
+        auto it = index_.find(id);
+        return it == index_.end() ? nullptr : &tasks_[it->second];
+    }
+
+    size_t count() const override { return tasks_.size(); }
+
+    size_t collect(uint64_t now, std::deque<SchedulerTask>& ready) override {
+        due_.clear();
+        for (size_t i = 0; i < tasks_.size(); i++) {
+            if (tasks_[i].next_run_ms <= now) due_.push_back(tasks_[i]);
+        }
+        std::sort(due_.begin(), due_.end(), runs_before);
+        for (const SchedulerTask& t : due_) {
+            ready.push_back(t);
+            size_t i = index_[t.id];
+            if (t.period_ms == 0) erase_at(i);
+            else tasks_[i].next_run_ms = next_after(t, now);
+        }
+        return due_.size();
+    }
+
+private:
+    void erase_at(size_t i) {
+        index_.erase(tasks_[i].id);
+        if (i + 1 != tasks_.size()) {
+            tasks_[i] = tasks_.back();
+            index_[tasks_[i].id] = i;
+        }
+        tasks_.pop_back();
+    }
+
+    std::vector<SchedulerTask> tasks_;
+    std::unordered_map<uint32_t, size_t> index_;
+    std::vector<SchedulerTask> due_;
+};
+
+#ifdef SCHEDULER_TRACE
+// Время вызова для трассы; без активной трассы часы не читаются
+class CallTimer {
+public:
+    explicit CallTimer(bool on) : on_(on) {
+        if (on_) start_ = std::chrono::steady_clock::now();
+    }
+
+    uint32_t ns() const {
+        if (!on_) return 0;
+        auto d = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+        return d.count() > 0xffffffffLL ? 0xffffffffu : uint32_t(d.count());
+    }
+
+private:
+    bool on_;
+    std::chrono::steady_clock::time_point start_;
+};
+#endif
+
+} // namespace
+
+struct Scheduler {
+    SchedulerEngine kind;
+    std::unique_ptr<Engine> engine;
+    std::deque<SchedulerTask> ready;
+#ifdef SCHEDULER_TRACE
+    std::unique_ptr<trace::Writer> trace;
+#endif
+};
+
+extern "C" {
+
+Scheduler* scheduler_create(SchedulerEngine engine) {
+    if (engine != SCHEDULER_ENGINE_HEAP && engine != SCHEDULER_ENGINE_LINEAR) return nullptr;
+    Scheduler* s = new (std::nothrow) Scheduler;
+    if (!s) return nullptr;
+    s->kind = engine;
+    if (engine == SCHEDULER_ENGINE_HEAP) s->engine.reset(new (std::nothrow) HeapEngine);
+    else s->engine.reset(new (std::nothrow) LinearEngine);
+    if (!s->engine) {
+        delete s;
+        return nullptr;
+    }
+    return s;
+}
+
+void scheduler_destroy(Scheduler* s) {
+    delete s;
+}
+
+SchedulerStatus scheduler_add(Scheduler* s, uint32_t id, const char* name, uint64_t period_ms,
+                              uint64_t first_run_ms) {
+    if (!s) return SCHEDULER_ERR_INVALID;
+#ifdef SCHEDULER_TRACE
+    CallTimer timer(s->trace != nullptr);
+#endif
+    SchedulerTask task = make_task(id, name, period_ms, first_run_ms);
+    SchedulerStatus status;
+    try {
+        status = s->engine->add(task) ? SCHEDULER_OK : SCHEDULER_ERR_EXISTS;
+    } catch (const std::bad_alloc&) {
+        status = SCHEDULER_ERR_NO_MEMORY;
+    }
+#ifdef SCHEDULER_TRACE
+    if (s->trace) {
+        trace::Record r;
+        r.op = trace::Op::Add;
+        r.ns = timer.ns();
+        r.id = id;
+        r.arg = period_ms;
+        r.first_run = first_run_ms;
+        r.name = task.name;
+        r.result = uint32_t(status);
+        s->trace->write(r);
+    }
+#endif
+    return status;
+}
+
+SchedulerStatus scheduler_remove(Scheduler* s, uint32_t id) {
+    if (!s) return SCHEDULER_ERR_INVALID;
+#ifdef SCHEDULER_TRACE
+    CallTimer timer(s->trace != nullptr);
+#endif
+    SchedulerStatus status = s->engine->remove(id) ? SCHEDULER_OK : SCHEDULER_ERR_NOT_FOUND;
+#ifdef SCHEDULER_TRACE
+    if (s->trace) {
+        trace::Record r;
+        r.op = trace::Op::Remove;
+        r.ns = timer.ns();
+        r.id = id;
+        r.result = uint32_t(status);
+        s->trace->write(r);
+    }
+#endif
+    return status;
+}
+
+SchedulerStatus scheduler_get(const Scheduler* s, uint32_t id, SchedulerTask* out) {
+    if (!s || !out) return SCHEDULER_ERR_INVALID;
+    const SchedulerTask* t = s->engine->find(id);
+    if (!t) return SCHEDULER_ERR_NOT_FOUND;
+    *out = *t;
+    return SCHEDULER_OK;
+}
+
+size_t scheduler_count(const Scheduler* s) {
+    return s ? s->engine->count() : 0;
+}
+
+size_t scheduler_tick(Scheduler* s, uint64_t now_ms) {
+    if (!s) return 0;
+#ifdef SCHEDULER_TRACE
+    CallTimer timer(s->trace != nullptr);
+#endif
+    size_t n = 0;
+    try {
+        n = s->engine->collect(now_ms, s->ready);
+    } catch (const std::bad_alloc&) {
+        // Задачи, не попавшие в очередь, остались на месте и будут готовы
+        // на следующем tick
+    }
+#ifdef SCHEDULER_TRACE
+    if (s->trace) {
+        trace::Record r;
+        r.op = trace::Op::Tick;
+        r.ns = timer.ns();
+        r.arg = now_ms;
+        r.result = uint32_t(n);
+        s->trace->write(r);
+    }
+#endif
+    return n;
+}
+
+size_t scheduler_pop_ready(Scheduler* s, SchedulerTask* out, size_t max) {
+    if (!s || (!out && max > 0)) return 0;
+#ifdef SCHEDULER_TRACE
+    CallTimer timer(s->trace != nullptr);
+#endif
+    size_t n = std::min(max, s->ready.size());
+    std::copy(s->ready.begin(), s->ready.begin() + std::ptrdiff_t(n), out);
+    s->ready.erase(s->ready.begin(), s->ready.begin() + std::ptrdiff_t(n));
+#ifdef SCHEDULER_TRACE
+    if (s->trace) {
+        trace::Record r;
+        r.op = trace::Op::Pop;
+        r.ns = timer.ns();
+        r.arg = max;
+        r.result = uint32_t(n);
+        s->trace->write(r);
+    }
+#endif
+    return n;
+}
+
+size_t scheduler_ready_count(const Scheduler* s) {
+    return s ? s->ready.size() : 0;
+}
+
+SchedulerStatus scheduler_trace_start(Scheduler* s, const char* path) {
+#ifdef SCHEDULER_TRACE
+    if (!s || !path) return SCHEDULER_ERR_INVALID;
+    std::unique_ptr<trace::Writer> w(new (std::nothrow) trace::Writer);
+    if (!w) return SCHEDULER_ERR_NO_MEMORY;
+    if (!w->open(path, uint32_t(s->kind))) return SCHEDULER_ERR_IO;
+    s->trace = std::move(w);
+    return SCHEDULER_OK;
+#else
+    (void)s;
+    (void)path;
+    return SCHEDULER_ERR_INVALID;
+#endif
+}
+
+SchedulerStatus scheduler_trace_stop(Scheduler* s) {
+#ifdef SCHEDULER_TRACE
+    if (!s || !s->trace) return SCHEDULER_ERR_INVALID;
+    bool ok = s->trace->close();
+    s->trace.reset();
+    return ok ? SCHEDULER_OK : SCHEDULER_ERR_IO;
+#else
+    (void)s;
+    return SCHEDULER_ERR_INVALID;
+#endif
+}
+
+} // extern "C"
@@ -0,0 +1,74 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Планировщик задач с внешним временем. Задачи не выполняются внутри:
+// scheduler_tick(now) переносит готовые задачи в очередь готовых, откуда
+// вызывающий код забирает их пакетами через scheduler_pop_ready.
+//
+// Порядок детерминирован: за один tick задачи попадают в очередь по
+// возрастанию (next_run_ms, id). Периодическая задача после запуска
+// переносится на первый момент next_run_ms + k * period_ms, больший now
+// (пропущенные запуски не копятся); одноразовая удаляется.
+typedef struct Scheduler Scheduler;
+
+#define SCHEDULER_NAME_LEN 32
+
+typedef struct {
+    uint32_t id;
+    char name[SCHEDULER_NAME_LEN];  // всегда с завершающим нулём
+    uint64_t period_ms;             // 0 — одноразовая
+    uint64_t next_run_ms;           // в очереди готовых — момент, на который задача была назначена
+} SchedulerTask;
+
+// Внутренняя структура: обе дают одинаковый результат
+typedef enum {
+    SCHEDULER_ENGINE_HEAP = 0,    // двоичная куча по (next_run_ms, id): tick — O(k log n)
+    SCHEDULER_ENGINE_LINEAR = 1   // массив, tick просматривает все задачи: O(n)
+} SchedulerEngine;
+
+typedef enum {
+    SCHEDULER_OK = 0,
+    SCHEDULER_ERR_INVALID = 1,    // нулевой указатель, неизвестный engine
+    SCHEDULER_ERR_EXISTS = 2,     // задача с таким id уже есть
+    SCHEDULER_ERR_NOT_FOUND = 3,
+    SCHEDULER_ERR_NO_MEMORY = 4,
+    SCHEDULER_ERR_IO = 5          // запись трассы
+} SchedulerStatus;
+
+Scheduler* scheduler_create(SchedulerEngine engine);
+void scheduler_destroy(Scheduler* s);
+
+// Имя обрезается до SCHEDULER_NAME_LEN - 1 байт
+SchedulerStatus scheduler_add(Scheduler* s, uint32_t id, const char* name, uint64_t period_ms,
+                              uint64_t first_run_ms);
+SchedulerStatus scheduler_remove(Scheduler* s, uint32_t id);
+SchedulerStatus scheduler_get(const Scheduler* s, uint32_t id, SchedulerTask* out);
+size_t scheduler_count(const Scheduler* s);
+
+// Переносит задачи с next_run_ms <= now_ms в очередь готовых; возвращает
+// их число
+size_t scheduler_tick(Scheduler* s, uint64_t now_ms);
+
+// До max задач из очереди готовых в out, в порядке постановки
+size_t scheduler_pop_ready(Scheduler* s, SchedulerTask* out, size_t max);
+size_t scheduler_ready_count(const Scheduler* s);
+
+// Запись трассы: каждый вызов add/remove/tick/pop_ready с аргументами,
+// результатом и длительностью в наносекундах пишется в файл (формат —
+// trace.hpp). Доступна, если модуль собран с SCHEDULER_TRACE; иначе
+// scheduler_trace_start возвращает SCHEDULER_ERR_INVALID.
+SchedulerStatus scheduler_trace_start(Scheduler* s, const char* path);
+SchedulerStatus scheduler_trace_stop(Scheduler* s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCHEDULER_H
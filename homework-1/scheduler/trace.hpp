@@ -0,0 +1,167 @@
+#pragma once
+// Формат трассы вызовов планировщика (порядок байт машины):
+//
+//   заголовок: "SCHTRACE", u32 версия, u32 engine записавшего планировщика
+//   запись:    u8 op, u32 длительность вызова в нс (с насыщением), далее
+//     Add     u32 id, u64 period_ms, u64 first_run_ms, u8 длина имени, имя, u8 статус
+//     Remove  u32 id, u8 статус
+//     Tick    u64 now_ms, u32 число ставших готовыми
+//     Pop     u32 max, u32 число выданных
+//
+// Запись внутри планировщика (scheduler_trace_start) и чтение в
+// scheduler_replay используют этот заголовок.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace trace {
+
+const char kMagic[8] = {'S', 'C', 'H', 'T', 'R', 'A', 'C', 'E'};
+const std::uint32_t kVersion = 1;
+
+enum class Op : std::uint8_t { Add = 1, Remove = 2, Tick = 3, Pop = 4 };
+
+struct Record {
+    Op op = Op::Tick;
+    std::uint32_t ns = 0;
+    std::uint32_t id = 0;        // Add, Remove
+    std::uint64_t arg = 0;       // Add: period_ms, Tick: now_ms, Pop: max
+    std::uint64_t first_run = 0; // Add
+    std::string name;            // Add
+    std::uint32_t result = 0;    // Add, Remove: статус; Tick, Pop: число задач
+};
+
+// Буферизованная запись через stdio; ошибки накапливаются в ok()
+class Writer {
+public:
+    ~Writer() { close(); }
+
+    bool open(const char* path, std::uint32_t engine) {
+        file_ = std::fopen(path, "wb");
+        if (!file_) return false;
+        put(kMagic, sizeof(kMagic));
+        put_u32(kVersion);
+        put_u32(engine);
+        return ok_;
+    }
+
+    void write(const Record& r) {
+        put_u8(std::uint8_t(r.op));
+        put_u32(r.ns);
+        switch (r.op) {
+        case Op::Add: {
+            std::uint8_t len = std::uint8_t(r.name.size() < 255 ? r.name.size() : 255);
+            put_u32(r.id);
+            put_u64(r.arg);
+            put_u64(r.first_run);
+            put_u8(len);
+            put(r.name.data(), len);
+            put_u8(std::uint8_t(r.result));
+            break;
+        }
+        case Op::Remove:
+            put_u32(r.id);
+            put_u8(std::uint8_t(r.result));
+            break;
+        case Op::Tick:
+            put_u64(r.arg);
+            put_u32(r.result);
+            break;
+        case Op::Pop:
+            put_u32(std::uint32_t(r.arg));
+            put_u32(r.result);
+            break;
+        }
+    }
+
+    // false — была ошибка записи
+    bool close() {
+        if (!file_) return ok_;
+        if (std::fclose(file_) != 0) ok_ = false;
+        file_ = nullptr;
+        return ok_;
+    }
+
+    bool ok() const { return ok_; }
+
+private:
+    void put(const void* p, std::size_t n) {
+        if (n > 0 && std::fwrite(p, 1, n, file_) != n) ok_ = false;
+    }
+    void put_u8(std::uint8_t v) { put(&v, sizeof(v)); }
+    void put_u32(std::uint32_t v) { put(&v, sizeof(v)); }
+    void put_u64(std::uint64_t v) { put(&v, sizeof(v)); }
+
+    std::FILE* file_ = nullptr;
+    bool ok_ = true;
+};
+
+class Reader {
+public:
+    ~Reader() {
+        if (file_) std::fclose(file_);
+    }
+
+    // false — файл не открылся или это не трасса
+    bool open(const char* path) {
+        file_ = std::fopen(path, "rb");
+        if (!file_) return false;
+        char magic[sizeof(kMagic)];
+        std::uint32_t version = 0;
+        return get(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0 && get_u32(version) &&
+               version == kVersion && get_u32(engine_);
+    }
+
+    std::uint32_t engine() const { return engine_; }
+
+    // false — конец трассы; bad() — обрыв посреди записи
+    bool next(Record& r) {
+        std::uint8_t op;
+        if (!get(&op, sizeof(op))) return false;
+        bool ok = get_u32(r.ns);
+        r.op = Op(op);
+        switch (r.op) {
+        case Op::Add: {
+            std::uint8_t len = 0, status = 0;
+            ok = ok && get_u32(r.id) && get_u64(r.arg) && get_u64(r.first_run) && get(&len, 1);
+            r.name.resize(len);
+            ok = ok && get(&r.name[0], len) && get(&status, 1);
+            r.result = status;
+            break;
+        }
+        case Op::Remove: {
+            std::uint8_t status = 0;
+            ok = ok && get_u32(r.id) && get(&status, 1);
+            r.result = status;
+            break;
+        }
+        case Op::Tick:
+            ok = ok && get_u64(r.arg) && get_u32(r.result);
+            break;
+        case Op::Pop: {
+            std::uint32_t max = 0;
+            ok = ok && get_u32(max) && get_u32(r.result);
+            r.arg = max;
+            break;
+        }
+        default:
+            ok = false;
+        }
+        bad_ = !ok;
+        return ok;
+    }
+
+    bool bad() const { return bad_; }
+
+private:
+    bool get(void* p, std::size_t n) { return n == 0 || std::fread(p, 1, n, file_) == n; }
+    bool get_u32(std::uint32_t& v) { return get(&v, sizeof(v)); }
+    bool get_u64(std::uint64_t& v) { return get(&v, sizeof(v)); }
+
+    std::FILE* file_ = nullptr;
+    std::uint32_t engine_ = 0;
+    bool bad_ = false;
+};
+
+} // namespace trace
@@ -0,0 +1,193 @@
+// Бенчмарк Matrix: случайные чтение/запись, обход и замена ячеек.
+//
+// size — площадь квадратной области [0, side) x [0, side), в которой
+// лежат случайные координаты; занята доля kDensity ячеек (матрица
+// разреженная, 10^8 ячеек области — около 10^6 узлов).
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.hpp"
+#include "matrix.hpp"
+
+typedef Matrix<int, 0> Grid;
+
+const double kDensity = 0.01;
+const std::uint64_t kProbes = 100000;
+
+struct Cell
+{
+	int i;
+	int j;
+};
+
+struct State
+{
+	Grid matrix;
+	std::vector<Cell> cells;   // занятые (с повторами, если координаты совпали)
+	std::vector<Cell> probes;  // запросы замеряемой операции
+	std::vector<std::pair<Cell, Cell>> churn;  // освободить first, занять second
+};
+
+static void print_usage(const char* prog)
+{
+	std::cout <<
+		"Usage: " << prog << " [options]\n"
+		"Matrix<int, 0> random get/set/iterate/churn over 10^3..10^8 cells (1% occupied).\n"
+		"Options:\n";
+}
+
+static int value_of(std::size_t k)
+{
+	return int(k % 1000) + 1;
+}
+
+static std::vector<Cell> random_cells(std::mt19937_64& rng, int side, std::uint64_t n)
+{
+	std::uniform_int_distribution<int> coord(0, side - 1);
+	std::vector<Cell> cells(n);
+	for (auto& c : cells)
+	{
+		c.i = coord(rng);
+		c.j = coord(rng);
+	}
+	return cells;
+}
+
+static std::vector<Cell> random_picks(std::mt19937_64& rng, const std::vector<Cell>& from, std::uint64_t n)
+{
+	std::uniform_int_distribution<std::size_t> pick(0, from.size() - 1);
+	std::vector<Cell> out(n);
+	for (auto& c : out)
+		c = from[pick(rng)];
+	return out;
+}
+
+static void fill(State& s)
+{
+	for (std::size_t k = 0; k < s.cells.size(); ++k)
+		s.matrix[s.cells[k].i][s.cells[k].j] = value_of(k);
+}
+
+int main(int argc, char** argv)
+{
+	bench::Options options;
+	if (!bench::parse_options(argc, argv, options, print_usage))
+		return 0;
+	bench::Runner runner("sparse_matrix", options);
+
+	const std::uint64_t max_cells = options.max_size ? options.max_size : 100000000;
+	for (std::uint64_t cells = 1000; cells <= max_cells; cells *= 10)
+	{
+		const int side = int(std::sqrt(double(cells)) + 0.5);
+		const std::uint64_t stored = std::max<std::uint64_t>(1, std::uint64_t(double(cells) * kDensity));
+		const std::uint64_t seed = cells;
+
+		// Пустая матрица, заполнение stored случайными ячейками
+		auto empty = [&]()
+		{
+			auto s = std::make_unique<State>();
+			std::mt19937_64 rng(seed);
+			s->cells = random_cells(rng, side, stored);
+			return s;
+		};
+		// Заполненная матрица и запросы
+		auto filled = [&](int probes_kind)
+		{
+			return [&, probes_kind]()
+			{
+				auto s = empty();
+				fill(*s);
+				std::mt19937_64 rng(seed + 1);
+				if (probes_kind == 0)
+					s->probes = random_picks(rng, s->cells, kProbes);
+				else if (probes_kind == 1)
+					s->probes = random_cells(rng, side, kProbes);
+				return s;
+			};
+		};
+
+		runner.run("set_fill", cells, stored, empty, [](std::unique_ptr<State>& s)
+		{
+			fill(*s);
+			bench::keep(s->matrix.size());
+		});
+
+		runner.run("get_hit", cells, kProbes, filled(0), [](std::unique_ptr<State>& s)
+		{
+			long long sum = 0;
+			for (const Cell& c : s->probes)
+				sum += (int)s->matrix[c.i][c.j];
+			bench::keep(sum);
+		});
+
+		runner.run("get_random", cells, kProbes, filled(1), [](std::unique_ptr<State>& s)
+		{
+			long long sum = 0;
+			for (const Cell& c : s->probes)
+				sum += (int)s->matrix[c.i][c.j];
+			bench::keep(sum);
+		});
+
+		runner.run("set_overwrite", cells, kProbes, filled(0), [](std::unique_ptr<State>& s)
+		{
+			int v = 1;
+			for (const Cell& c : s->probes)
+			{
+				s->matrix[c.i][c.j] = v;
+				v = v % 1000 + 1;
+			}
+			bench::keep(s->matrix.size());
+		});
+
+		// Проходов столько, чтобы операций было не меньше kProbes
+		const std::uint64_t passes = (kProbes + stored - 1) / stored;
+		runner.run("iterate", cells, passes * stored, filled(2), [passes](std::unique_ptr<State>& s)
+		{
+			long long sum = 0;
+			for (std::uint64_t p = 0; p < passes; ++p)
+			{
+				for (auto c : s->matrix)
+					sum += std::get<2>(c);
+			}
+			bench::keep(sum);
+		});
+
+		// Одна операция — освободить занятую ячейку и занять новую
+		auto churned = [&]()
+		{
+			auto s = filled(2)();
+			std::mt19937_64 rng(seed + 2);
+			std::uniform_int_distribution<int> coord(0, side - 1);
+			std::vector<Cell> live = s->cells;
+			s->churn.resize(kProbes);
+			for (auto& op : s->churn)
+			{
+				std::size_t k = std::uniform_int_distribution<std::size_t>(0, live.size() - 1)(rng);
+				op.first = live[k];
+				op.second = Cell{coord(rng), coord(rng)};
+				live[k] = op.second;
+			}
+			return s;
+		};
+		runner.run("churn", cells, kProbes, churned, [](std::unique_ptr<State>& s)
+		{
+			int v = 1;
+			for (const auto& op : s->churn)
+			{
+				s->matrix[op.first.i][op.first.j] = 0;
+				s->matrix[op.second.i][op.second.j] = v;
+				v = v % 1000 + 1;
+			}
+			bench::keep(s->matrix.size());
+		});
+	}
+
+	return runner.finish() ? 0 : 1;
+}
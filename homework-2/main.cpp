@@ -108,4 +108,3 @@ int main()
 
 	return 0;
 }
-}
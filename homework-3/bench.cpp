@@ -0,0 +1,185 @@
+// Бенчмарк аллокаторов: вставки в std::map и Container, замена ключей map
+// (erase + insert) под std::allocator, Allocator и ResizableAllocator.
+//
+// size — число элементов. Allocator не освобождает память, поэтому его
+// буфер рассчитан на все узлы прогона, включая вставки при замене.
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "allocator.hpp"
+#include "resizable_allocator.hpp"
+#include "container.hpp"
+
+#include "bench.hpp"
+
+typedef std::pair<const int, long long> Pair;
+
+const std::uint64_t kChurn = 100000;
+const std::size_t kNodeBytes = 64;        // с запасом на узел std::map<int, long long>
+const std::size_t kResizableBlock = 65536;
+
+struct StdAlloc
+{
+    template<class T>
+    using type = std::allocator<T>;
+
+    static const char* name() { return "std"; }
+
+    template<class T>
+    static type<T> make(std::size_t) { return type<T>(); }
+};
+
+struct FixedAlloc
+{
+    template<class T>
+    using type = Allocator<T>;
+
+    static const char* name() { return "fixed"; }
+
+    template<class T>
+    static type<T> make(std::size_t nodes) { return type<T>(nodes * kNodeBytes + 4096); }
+};
+
+struct ResizableAlloc
+{
+    template<class T>
+    using type = ResizableAllocator<T>;
+
+    static const char* name() { return "resizable"; }
+
+    template<class T>
+    static type<T> make(std::size_t) { return type<T>(kResizableBlock); }
+};
+
+template<class A>
+using MapOf = std::map<int, long long, std::less<int>, typename A::template type<Pair>>;
+
+template<class A>
+struct MapState
+{
+    MapOf<A> map;
+    std::vector<int> keys;                   // порядок вставки
+    std::vector<std::pair<int, int>> churn;  // удалить first, вставить second
+
+    explicit MapState(std::size_t nodes)
+        : map(std::less<int>(), A::template make<Pair>(nodes))
+    {
+    }
+};
+
+template<class A>
+struct ContainerState
+{
+    Container<int, typename A::template type<int>> container;
+
+    explicit ContainerState(std::size_t nodes)
+        : container(A::template make<int>(nodes))
+    {
+    }
+};
+
+static void print_usage(const char* prog)
+{
+    std::cout <<
+        "Usage: " << prog << " [options]\n"
+        "std::map and Container inserts and map churn under std::allocator,\n"
+        "Allocator and ResizableAllocator, 10^3..10^6 elements.\n"
+        "Options:\n";
+}
+
+static std::vector<int> shuffled_keys(std::uint64_t n, std::uint64_t seed)
+{
+    std::vector<int> keys(n);
+    for (std::size_t i = 0; i < keys.size(); i++)
+        keys[i] = int(i);
+    std::mt19937_64 rng(seed);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+template<class A>
+void run_allocator(bench::Runner& runner, std::uint64_t n)
+{
+    const std::string suffix = std::string("/") + A::name();
+
+    auto empty_map = [n]()
+    {
+        auto s = std::make_unique<MapState<A>>(n + kChurn);
+        s->keys = shuffled_keys(n, n);
+        return s;
+    };
+
+    runner.run("map_insert" + suffix, n, n, empty_map, [](std::unique_ptr<MapState<A>>& s)
+    {
+        for (int k : s->keys)
+            s->map.emplace(k, (long long)k);
+        bench::keep(s->map.size());
+    });
+
+    runner.run("container_push" + suffix, n, n, [n]()
+    {
+        return std::make_unique<ContainerState<A>>(n);
+    }, [n](std::unique_ptr<ContainerState<A>>& s)
+    {
+        for (std::uint64_t i = 0; i < n; i++)
+            s->container.push_back(int(i));
+        bench::keep(s->container.size());
+    });
+
+    // Случайный живой ключ удаляется, вставляется новый: размер map
+    // постоянен, узлы освобождаются и занимаются вперемешку
+    auto churned_map = [n, empty_map]()
+    {
+        auto s = empty_map();
+        for (int k : s->keys)
+            s->map.emplace(k, (long long)k);
+
+        std::vector<int> live = s->keys;
+        std::mt19937_64 rng(n + 1);
+        s->churn.resize(kChurn);
+        int next = int(n);
+        for (auto& op : s->churn)
+        {
+            std::size_t i = std::uniform_int_distribution<std::size_t>(0, live.size() - 1)(rng);
+            op.first = live[i];
+            op.second = next++;
+            live[i] = op.second;
+        }
+        return s;
+    };
+
+    runner.run("map_churn" + suffix, n, kChurn, churned_map, [](std::unique_ptr<MapState<A>>& s)
+    {
+        for (const auto& op : s->churn)
+        {
+            s->map.erase(op.first);
+            s->map.emplace(op.second, (long long)op.second);
+        }
+        bench::keep(s->map.size());
+    });
+}
+
+int main(int argc, char** argv)
+{
+    bench::Options options;
+    if (!bench::parse_options(argc, argv, options, print_usage))
+        return 0;
+    bench::Runner runner("allocator_task", options);
+
+    const std::uint64_t max_n = options.max_size ? options.max_size : 1000000;
+    for (std::uint64_t n = 1000; n <= max_n; n *= 10)
+    {
+        run_allocator<StdAlloc>(runner, n);
+        run_allocator<FixedAlloc>(runner, n);
+        run_allocator<ResizableAlloc>(runner, n);
+    }
+
+    return runner.finish() ? 0 : 1;
+}
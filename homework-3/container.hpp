@@ -1,8 +1,9 @@
 #pragma once
+#include <cstddef>
 #include <memory>
 #include <new>
 
-typedef unsigned long long size_type;
+typedef std::size_t size_type;
 
 template<class T, class Alloc = std::allocator<T>>
 class Container
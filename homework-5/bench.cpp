@@ -0,0 +1,123 @@
+// Сравнение format_ip_to() и print_ip_batch() с std::ostream и snprintf на случайных адресах.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "print_ip.hpp"
+#include "print_ip_batch.hpp"
+
+struct Result {
+    double ns_per_op;
+    std::uint64_t checksum;
+};
+
+template<class F>
+static Result run(std::size_t count, F&& body) {
+    std::uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; i++)
+        checksum += body(i);
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    return {ns / double(count), checksum};
+}
+
+// Пакетный вызов печатает все count адресов за раз; время делится на count
+template<class F>
+static Result run_batch(std::size_t count, F&& body) {
+    std::uint64_t checksum = 0;
+    auto sink = [&checksum](const char* data, std::size_t size) {
+        checksum += size + std::size_t(data[0]);
+    };
+    auto start = std::chrono::steady_clock::now();
+    body(sink);
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    return {ns / double(count), checksum};
+}
+
+static void report(const char* type, const char* method, const Result& r) {
+    std::cout << std::left << std::setw(10) << type << std::setw(14) << method
+              << std::right << std::fixed << std::setprecision(1) << std::setw(8)
+              << r.ns_per_op << " ns/op   (checksum " << r.checksum << ")\n";
+}
+
+template<class T>
+static void bench_type(const char* type, const std::vector<T>& values) {
+    const std::size_t n = values.size();
+
+    // Поток: побайтовый operator<< в переиспользуемый ostringstream
+    std::ostringstream oss;
+    report(type, "ostream", run(n, [&](std::size_t i) {
+        oss.str(std::string());
+        using U = std::make_unsigned_t<T>;
+        U bits = static_cast<U>(values[i]);
+        for (std::size_t b = sizeof(T); b-- > 0;) {
+            oss << ((bits >> (b * 8)) & 0xFF);
+            if (b != 0) oss << '.';
+        }
+        return oss.tellp();
+    }));
+
+    // snprintf: побайтово в общий буфер
+    char buf[ip_buffer_size<T>];
+    report(type, "snprintf", run(n, [&](std::size_t i) {
+        using U = std::make_unsigned_t<T>;
+        U bits = static_cast<U>(values[i]);
+        int len = 0;
+        for (std::size_t b = sizeof(T); b-- > 0;) {
+            len += std::snprintf(buf + len, sizeof(buf) - len, b != 0 ? "%u." : "%u",
+                                 unsigned((bits >> (b * 8)) & 0xFF));
+        }
+        return std::size_t(len) + std::size_t(buf[0]);
+    }));
+
+    report(type, "format_ip_to", run(n, [&](std::size_t i) {
+        return format_ip_to(buf, sizeof(buf), values[i]) + std::size_t(buf[0]);
+    }));
+
+    // Весь массив одним вызовом: адреса через '\n' в общий буфер
+    report(type, "batch", run_batch(n, [&](auto& sink) {
+        print_ip_batch(values, sink);
+    }));
+}
+
+static void bench_containers(std::mt19937_64& rng, std::size_t count) {
+    std::vector<std::vector<int>> values(count);
+    for (auto& v : values) {
+        v.resize(4);
+        for (auto& x : v) x = static_cast<int>(rng() % 1000);
+    }
+
+    std::ostringstream oss;
+    report("vector", "print_ip", run(count, [&](std::size_t i) {
+        print_ip(values[i], oss);
+        return std::size_t(0);
+    }));
+
+    report("vector", "batch", run_batch(count, [&](auto& sink) {
+        print_ip_batch(values, sink);
+    }));
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    std::mt19937_64 rng(42);
+
+    std::vector<uint32_t> v32(count);
+    for (auto& v : v32) v = static_cast<uint32_t>(rng());
+    std::vector<int64_t> v64(count);
+    for (auto& v : v64) v = static_cast<int64_t>(rng());
+
+    std::cout << "addresses per run: " << count << "\n";
+    bench_type("uint32_t", v32);
+    bench_type("int64_t", v64);
+    bench_containers(rng, count / 4);
+    return 0;
+}
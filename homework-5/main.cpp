@@ -0,0 +1,56 @@
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "print_ip.hpp"
+#include "print_ip_batch.hpp"
+
+int main()
+{
+    print_ip( int8_t{-1} ); // 255
+    print_ip( int16_t{0} ); // 0.0
+    print_ip( int32_t{2130706433} ); // 127.0.0.1
+    print_ip( int64_t{8875824491850138409} ); // 123.45.67.89.101.112.131.41
+    print_ip( std::string{"Hello, World!"} ); // Hello, World!
+    print_ip( std::vector<int>{100, 200, 300, 400} ); // 100.200.300.400
+    print_ip( std::list<short>{400, 300, 200, 100} ); // 400.300.200.100
+    print_ip( std::make_tuple(123, 456, 789, 0) ); // 123.456.789.0
+
+    // Запись в буфер без потоков и аллокаций
+    char buf[ip_buffer_size<int64_t>];
+    std::size_t len = format_ip_to(buf, sizeof(buf), int64_t{8875824491850138409});
+    std::cout << buf << " (" << len << " chars)" << std::endl;
+
+    // Обрезка по ёмкости как у snprintf
+    char small[8];
+    len = format_ip_to(small, sizeof(small), int32_t{2130706433});
+    std::cout << small << " (needed " << len << ")" << std::endl;
+
+    // Константные адреса вычисляются при компиляции
+    constexpr auto localhost = make_ip(int32_t{2130706433});
+    static_assert(localhost.view() == "127.0.0.1");
+    static_assert(decltype(localhost)::capacity() == 15);
+
+    constexpr auto tuple_ip = make_ip(std::make_tuple(123, 456, 789, 0));
+    static_assert(tuple_ip.view() == "123.456.789.0");
+
+    std::cout << localhost << std::endl;
+    std::cout << tuple_ip << std::endl;
+    std::cout << make_ip(int64_t{-1}) << std::endl;
+
+    // Пакетная печать: один буфер на много адресов
+    auto to_cout = [](const char* data, std::size_t size) {
+        std::cout.write(data, static_cast<std::streamsize>(size));
+    };
+    std::vector<uint32_t> addresses{2130706433, 3232235777, 167772161};
+    print_ip_batch(addresses, to_cout);
+
+    std::list<std::vector<int>> nested{{10, 0, 0, 1}, {192, 168, 1, 1}};
+    print_ip_batch(nested, to_cout, ' ');
+    std::cout << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,334 @@
+#pragma once
+/// @file print_ip.hpp
+/// @brief Печать условного IP-адреса через SFINAE.
+///
+/// Помимо print_ip() файл содержит семейство format_ip() / format_ip_to(),
+/// которое пишет адрес в итератор или в буфер без аллокаций и без
+/// потоковой машинерии (локали, sentry, виртуальные вызовы streambuf).
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace detail {
+
+/// @brief Десятичная запись одного байта: длина и до трёх цифр.
+struct ByteDigits
+{
+    unsigned char len;
+    char text[3];
+};
+
+constexpr std::array<ByteDigits, 256> make_byte_table()
+{
+    std::array<ByteDigits, 256> table{};
+    for (unsigned v = 0; v < 256; ++v) {
+        ByteDigits& d = table[v];
+        if (v >= 100) {
+            d.len = 3;
+            d.text[0] = char('0' + v / 100);
+            d.text[1] = char('0' + v / 10 % 10);
+            d.text[2] = char('0' + v % 10);
+        } else if (v >= 10) {
+            d.len = 2;
+            d.text[0] = char('0' + v / 10);
+            d.text[1] = char('0' + v % 10);
+        } else {
+            d.len = 1;
+            d.text[0] = char('0' + v);
+        }
+    }
+    return table;
+}
+
+/// @brief Таблица байт -> десятичная строка, строится при компиляции.
+inline constexpr std::array<ByteDigits, 256> byte_table = make_byte_table();
+
+template<class T>
+struct is_ip_integral
+    : std::bool_constant<std::is_integral_v<T> && !std::is_same_v<T, bool>> {};
+
+template<class T>
+struct is_vector_or_list : std::false_type {};
+
+template<class T, class A>
+struct is_vector_or_list<std::vector<T, A>> : std::true_type {};
+
+template<class T, class A>
+struct is_vector_or_list<std::list<T, A>> : std::true_type {};
+
+template<class T>
+struct is_homogeneous_tuple : std::false_type {};
+
+template<class Head, class... Tail>
+struct is_homogeneous_tuple<std::tuple<Head, Tail...>>
+    : std::bool_constant<(std::is_same_v<Head, Tail> && ...)> {};
+
+template<class T>
+struct is_integral_tuple : std::false_type {};
+
+template<class Head, class... Tail>
+struct is_integral_tuple<std::tuple<Head, Tail...>>
+    : std::bool_constant<is_homogeneous_tuple<std::tuple<Head, Tail...>>::value
+                         && is_ip_integral<Head>::value> {};
+
+/// @brief Итератор вывода в буфер фиксированной ёмкости.
+///
+/// Всё, что не помещается, отбрасывается, но учитывается в count —
+/// так format_ip_to() может вернуть требуемую длину, как snprintf.
+struct BoundedWriter
+{
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    char* pos;
+    char* end;
+    std::size_t count;
+
+    BoundedWriter& operator=(char c)
+    {
+        if (pos != end)
+            *pos++ = c;
+        ++count;
+        return *this;
+    }
+
+    BoundedWriter& operator*() { return *this; }
+    BoundedWriter& operator++() { return *this; }
+    BoundedWriter& operator++(int) { return *this; }
+};
+
+template<class OutIt, class E>
+auto write_element(OutIt out, const E& value)
+    -> std::enable_if_t<is_ip_integral<E>::value, OutIt>
+{
+    char digits[24];
+    auto res = std::to_chars(digits, digits + sizeof(digits), value);
+    return std::copy(digits, res.ptr, out);
+}
+
+template<class OutIt, class E>
+auto write_element(OutIt out, const E& value)
+    -> std::enable_if_t<std::is_same_v<E, std::string>, OutIt>
+{
+    return std::copy(value.begin(), value.end(), out);
+}
+
+/// @brief Максимальная длина десятичной записи целого E вместе со знаком.
+template<class E>
+constexpr std::size_t decimal_max_length()
+{
+    return std::size_t(std::numeric_limits<E>::digits10) + 1 + (std::is_signed_v<E> ? 1 : 0);
+}
+
+/// @brief constexpr-вариант побайтовой записи целого, возвращает конец записи.
+template<class T>
+constexpr char* write_integral_ip(char* out, T value)
+{
+    using U = std::make_unsigned_t<T>;
+    const U bits = static_cast<U>(value);
+
+    for (std::size_t i = sizeof(T); i-- > 0;) {
+        const ByteDigits& d = byte_table[(bits >> (i * 8)) & 0xFF];
+        for (unsigned k = 0; k < d.len; ++k)
+            *out++ = d.text[k];
+        if (i != 0)
+            *out++ = '.';
+    }
+    return out;
+}
+
+/// @brief constexpr-замена std::to_chars для целых (в C++17 она не constexpr).
+template<class E>
+constexpr char* write_decimal(char* out, E value)
+{
+    using U = std::make_unsigned_t<E>;
+    U magnitude = static_cast<U>(value);
+    if constexpr (std::is_signed_v<E>) {
+        if (value < 0) {
+            *out++ = '-';
+            magnitude = static_cast<U>(U(0) - magnitude);
+        }
+    }
+
+    char digits[std::numeric_limits<U>::digits10 + 1] = {};
+    std::size_t n = 0;
+    do {
+        digits[n++] = char('0' + magnitude % 10);
+        magnitude = static_cast<U>(magnitude / 10);
+    } while (magnitude != 0);
+
+    while (n > 0)
+        *out++ = digits[--n];
+    return out;
+}
+
+template<class T>
+struct ip_tuple_length;
+
+template<class Head, class... Tail>
+struct ip_tuple_length<std::tuple<Head, Tail...>>
+    : std::integral_constant<std::size_t,
+                             (1 + sizeof...(Tail)) * (decimal_max_length<Head>() + 1) - 1> {};
+
+} // namespace detail
+
+/// @brief Максимальная длина записи целого типа T: 3 цифры на байт и точки между ними.
+template<class T>
+constexpr std::size_t ip_max_length()
+{
+    return sizeof(T) * 4 - 1;
+}
+
+/// @brief Размер буфера для format_ip_to(), гарантированно вмещающего любое значение T.
+template<class T>
+inline constexpr std::size_t ip_buffer_size = ip_max_length<T>() + 1;
+
+/// @brief Строка фиксированной ёмкости N поверх std::array, пригодная для constexpr.
+///
+/// Хранит завершающий ноль, поэтому c_str() можно отдавать в C API.
+template<std::size_t N>
+struct IpString
+{
+    std::array<char, N + 1> chars{};
+    std::size_t length = 0;
+
+    static constexpr std::size_t capacity() { return N; }
+    constexpr std::size_t size() const { return length; }
+    constexpr const char* data() const { return chars.data(); }
+    constexpr const char* c_str() const { return chars.data(); }
+    constexpr std::string_view view() const { return std::string_view(chars.data(), length); }
+};
+
+template<std::size_t N>
+std::ostream& operator<<(std::ostream& os, const IpString<N>& ip)
+{
+    return os.write(ip.data(), static_cast<std::streamsize>(ip.size()));
+}
+
+/// @brief Формирует запись целого в IpString<4 * sizeof(T) - 1>.
+///
+/// Для констант результат вычисляется при компиляции, для остальных
+/// значений это буфер на стеке без обращений к куче.
+template<class T>
+constexpr auto make_ip(const T& value)
+    -> std::enable_if_t<detail::is_ip_integral<T>::value, IpString<ip_max_length<T>()>>
+{
+    IpString<ip_max_length<T>()> ip;
+    const char* end = detail::write_integral_ip(ip.chars.data(), value);
+    ip.length = std::size_t(end - ip.chars.data());
+    return ip;
+}
+
+/// @brief Формирует запись кортежа одинаковых целых; ёмкость выводится из арности.
+template<class T>
+constexpr auto make_ip(const T& value)
+    -> std::enable_if_t<detail::is_integral_tuple<T>::value,
+                        IpString<detail::ip_tuple_length<T>::value>>
+{
+    IpString<detail::ip_tuple_length<T>::value> ip;
+    char* out = ip.chars.data();
+    std::apply([&out](const auto& head, const auto&... tail) {
+        out = detail::write_decimal(out, head);
+        ((*out++ = '.', out = detail::write_decimal(out, tail)), ...);
+    }, value);
+    ip.length = std::size_t(out - ip.chars.data());
+    return ip;
+}
+
+/// @brief Записывает целое побайтово, начиная со старшего байта.
+/// @param out итератор вывода символов
+/// @param value адрес
+/// @return итератор за последним записанным символом
+template<class OutIt, class T>
+auto format_ip(OutIt out, const T& value)
+    -> std::enable_if_t<detail::is_ip_integral<T>::value, OutIt>
+{
+    const auto ip = make_ip(value);
+    return std::copy_n(ip.data(), ip.size(), out);
+}
+
+/// @brief Записывает строку как есть.
+template<class OutIt, class T>
+auto format_ip(OutIt out, const T& value)
+    -> std::enable_if_t<std::is_same_v<T, std::string>, OutIt>
+{
+    return std::copy(value.begin(), value.end(), out);
+}
+
+/// @brief Записывает элементы std::vector / std::list через точку.
+template<class OutIt, class T>
+auto format_ip(OutIt out, const T& value)
+    -> std::enable_if_t<detail::is_vector_or_list<T>::value, OutIt>
+{
+    bool first = true;
+    for (const auto& element : value) {
+        if (!first)
+            *out++ = '.';
+        out = detail::write_element(out, element);
+        first = false;
+    }
+    return out;
+}
+
+/// @brief Записывает элементы кортежа с одинаковыми типами через точку.
+///
+/// Для кортежа с разными типами подходящей перегрузки нет — ошибка компиляции.
+template<class OutIt, class T>
+auto format_ip(OutIt out, const T& value)
+    -> std::enable_if_t<detail::is_homogeneous_tuple<T>::value, OutIt>
+{
+    std::apply([&out](const auto& head, const auto&... tail) {
+        out = detail::write_element(out, head);
+        ((*out++ = '.', out = detail::write_element(out, tail)), ...);
+    }, value);
+    return out;
+}
+
+/// @brief Пишет адрес в буфер buf ёмкостью cap с семантикой snprintf.
+///
+/// В буфер попадает не более cap - 1 символов и завершающий ноль.
+/// @return полная длина записи; если она >= cap, результат обрезан
+template<class T>
+auto format_ip_to(char* buf, std::size_t cap, const T& value)
+    -> decltype(format_ip(buf, value), std::size_t())
+{
+    // Длина целого известна сверху ещё при компиляции: если буфер её вмещает,
+    // пишем напрямую без проверок на каждый символ
+    if constexpr (detail::is_ip_integral<T>::value) {
+        if (cap > ip_max_length<T>()) {
+            char* end = detail::write_integral_ip(buf, value);
+            *end = '\0';
+            return std::size_t(end - buf);
+        }
+    }
+
+    if (cap == 0)
+        return format_ip(detail::BoundedWriter{buf, buf, 0}, value).count;
+
+    detail::BoundedWriter w = format_ip(detail::BoundedWriter{buf, buf + cap - 1, 0}, value);
+    *w.pos = '\0';
+    return w.count;
+}
+
+/// @brief Печатает адрес в поток, завершая строку переводом строки.
+template<class T>
+auto print_ip(const T& value, std::ostream& os = std::cout)
+    -> decltype(format_ip(std::ostreambuf_iterator<char>(os), value), void())
+{
+    format_ip(std::ostreambuf_iterator<char>(os), value);
+    os << '\n';
+}
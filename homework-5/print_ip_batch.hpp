@@ -0,0 +1,205 @@
+#pragma once
+/// @file print_ip_batch.hpp
+/// @brief Пакетная печать множества адресов в один непрерывный буфер.
+///
+/// Вместо вызова print_ip() на каждый адрес адреса форматируются блоками:
+/// байты нескольких чисел разворачиваются в порядок «старший первым»
+/// одной перестановкой (pshufb при наличии SSSE3), затем цифры выводятся
+/// по таблице detail::byte_table без ветвлений по длине. Готовый буфер
+/// отдаётся в sink(const char* data, std::size_t size) крупными кусками.
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#include "print_ip.hpp"
+
+/// @brief Размер внутреннего буфера пакетной печати.
+inline constexpr std::size_t ip_batch_buffer_size = 64 * 1024;
+
+namespace detail {
+
+/// @brief Число адресов типа T, обрабатываемых за один шаг (один 16-байтный вектор).
+template<class T>
+inline constexpr std::size_t ip_batch_lanes = sizeof(T) <= 16 ? 16 / sizeof(T) : 1;
+
+/// @brief Раскладывает ip_batch_lanes<T> чисел в байты, старший байт каждого первым.
+template<class T>
+inline void load_octets(const T* src, unsigned char* octets)
+{
+    constexpr std::size_t S = sizeof(T);
+    constexpr std::size_t lanes = ip_batch_lanes<T>;
+
+#if defined(__SSSE3__)
+    if constexpr (S > 1 && S * lanes == 16) {
+        // Маска переворота байтов внутри каждой дорожки шириной S
+        alignas(16) static const auto mask = [] {
+            std::array<unsigned char, 16> m{};
+            for (std::size_t k = 0; k < 16; ++k)
+                m[k] = static_cast<unsigned char>(k / S * S + (S - 1 - k % S));
+            return m;
+        }();
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        v = _mm_shuffle_epi8(v, _mm_load_si128(reinterpret_cast<const __m128i*>(mask.data())));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(octets), v);
+        return;
+    }
+#endif
+
+    using U = std::make_unsigned_t<T>;
+    for (std::size_t k = 0; k < lanes; ++k) {
+        const U bits = static_cast<U>(src[k]);
+        for (std::size_t b = 0; b < S; ++b)
+            octets[k * S + b] = static_cast<unsigned char>((bits >> ((S - 1 - b) * 8)) & 0xFF);
+    }
+}
+
+/// @brief Выводит count адресов из подготовленных байтов.
+///
+/// Каждый байт пишется безусловной 3-байтной записью из таблицы, после чего
+/// указатель сдвигается на реальную длину — поэтому буфер должен иметь запас
+/// в 3 байта за концом последнего адреса.
+template<class T>
+inline char* emit_octets(char* out, const unsigned char* octets, std::size_t count, char sep)
+{
+    constexpr std::size_t S = sizeof(T);
+    for (std::size_t k = 0; k < count; ++k) {
+        for (std::size_t b = 0; b < S; ++b) {
+            const ByteDigits& d = byte_table[octets[k * S + b]];
+            std::memcpy(out, d.text, 3);
+            out += d.len;
+            *out++ = '.';
+        }
+        out[-1] = sep;
+    }
+    return out;
+}
+
+template<class Range, class = void>
+struct has_data : std::false_type {};
+
+template<class Range>
+struct has_data<Range, std::void_t<decltype(std::data(std::declval<const Range&>()))>>
+    : std::true_type {};
+
+/// @brief Итератор вывода, сбрасывающий заполненный буфер в sink.
+template<class Sink>
+struct SinkWriter
+{
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    char* begin;
+    char* pos;
+    char* end;
+    Sink* sink;
+
+    SinkWriter& operator=(char c)
+    {
+        if (pos == end) {
+            (*sink)(static_cast<const char*>(begin), std::size_t(pos - begin));
+            pos = begin;
+        }
+        *pos++ = c;
+        return *this;
+    }
+
+    SinkWriter& operator*() { return *this; }
+    SinkWriter& operator++() { return *this; }
+    SinkWriter& operator++(int) { return *this; }
+};
+
+/// @brief Общий цикл для целочисленных адресов: блоки по ip_batch_lanes<T>.
+template<class It, class Sink>
+void print_integral_batch(It first, It last, Sink& sink, char sep)
+{
+    using T = typename std::iterator_traits<It>::value_type;
+    constexpr std::size_t lanes = ip_batch_lanes<T>;
+    // Худший случай на блок: полные адреса плюс разделители и запас под memcpy
+    constexpr std::size_t block_bytes = lanes * (ip_max_length<T>() + 1) + 3;
+    static_assert(block_bytes < ip_batch_buffer_size, "batch buffer is too small");
+
+    char buffer[ip_batch_buffer_size];
+    char* out = buffer;
+    T block[lanes] = {};
+    unsigned char octets[lanes * sizeof(T)];
+
+    while (first != last) {
+        // Полные блоки из непрерывной памяти читаются на месте, остальное — через копию
+        const T* src = block;
+        std::size_t n = 0;
+        if constexpr (std::is_pointer_v<It>) {
+            n = std::size_t(last - first) < lanes ? std::size_t(last - first) : lanes;
+            if (n == lanes)
+                src = first;
+            else
+                std::memcpy(block, first, n * sizeof(T));
+            first += n;
+        } else {
+            for (; n < lanes && first != last; ++n, ++first)
+                block[n] = *first;
+        }
+
+        if (std::size_t(buffer + sizeof(buffer) - out) < block_bytes) {
+            sink(static_cast<const char*>(buffer), std::size_t(out - buffer));
+            out = buffer;
+        }
+        load_octets(src, octets);
+        out = emit_octets<T>(out, octets, n, sep);
+    }
+
+    if (out != buffer)
+        sink(static_cast<const char*>(buffer), std::size_t(out - buffer));
+}
+
+} // namespace detail
+
+/// @brief Печатает count целочисленных адресов, разделяя их символом sep.
+/// @param data адреса
+/// @param count количество адресов
+/// @param sink вызываемый объект sink(const char* data, std::size_t size)
+/// @param sep разделитель после каждого адреса
+template<class T, class Sink>
+auto print_ip_batch(const T* data, std::size_t count, Sink&& sink, char sep = '\n')
+    -> std::enable_if_t<detail::is_ip_integral<T>::value>
+{
+    detail::print_integral_batch(data, data + count, sink, sep);
+}
+
+/// @brief Печатает диапазон целочисленных адресов (std::vector, std::array, std::list, ...).
+template<class Range, class Sink>
+auto print_ip_batch(const Range& range, Sink&& sink, char sep = '\n')
+    -> std::enable_if_t<detail::is_ip_integral<typename Range::value_type>::value>
+{
+    if constexpr (detail::has_data<Range>::value)
+        detail::print_integral_batch(std::data(range), std::data(range) + std::size(range), sink, sep);
+    else
+        detail::print_integral_batch(std::begin(range), std::end(range), sink, sep);
+}
+
+/// @brief Печатает диапазон адресов-контейнеров std::vector / std::list через общий буфер.
+template<class Range, class Sink>
+auto print_ip_batch(const Range& range, Sink&& sink, char sep = '\n')
+    -> std::enable_if_t<detail::is_vector_or_list<typename Range::value_type>::value>
+{
+    using Sink_t = std::remove_reference_t<Sink>;
+    char buffer[ip_batch_buffer_size];
+    detail::SinkWriter<Sink_t> out{buffer, buffer, buffer + sizeof(buffer), &sink};
+
+    for (const auto& address : range) {
+        out = format_ip(out, address);
+        *out++ = sep;
+    }
+
+    if (out.pos != buffer)
+        sink(static_cast<const char*>(buffer), std::size_t(out.pos - buffer));
+}
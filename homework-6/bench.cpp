@@ -0,0 +1,277 @@
+// Сравнение режимов поиска на файлах из inputs/ и на сгенерированных
+// разреженных матрицах 2e5 x 2e5 (случайной и гарантированно без циклов).
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "binary_matrix.hpp"
+#include "incremental.hpp"
+#include "matrix_io.hpp"
+#include "solver.hpp"
+#include "work_pool.hpp"
+
+namespace fs = std::filesystem;
+
+#ifndef FOUR_CYCLE_INPUTS_DIR
+#define FOUR_CYCLE_INPUTS_DIR "inputs"
+#endif
+
+struct Args {
+    std::string inputs = FOUR_CYCLE_INPUTS_DIR;
+    std::size_t rows = 200000;
+    std::size_t cols = 200000;
+    std::size_t degree = 4;
+    std::uint64_t seed = 42;
+    std::size_t mem_limit = std::size_t(1) << 30;
+    int repeats = 3;
+    std::size_t threads = 0;  // для параллельных замеров, 0 — все ядра
+    std::size_t flips = 100000;
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options] [inputs_dir]\n"
+        "Options:\n"
+        "  --rows N          rows of the generated sparse case (default: 200000)\n"
+        "  --cols M          columns of the generated sparse case (default: 200000)\n"
+        "  --degree D        ones per row in the random sparse case (default: 4)\n"
+        "  --seed X          random seed (default: 42)\n"
+        "  --mem-limit MIB   memory cap for bitsets / pair storage (default: 1024)\n"
+        "  --repeats R       runs per measurement, median is reported (default: 3)\n"
+        "  --threads T       threads for the parallel rows, 0 = all cores (default: 0)\n"
+        "  --flips K         random set/clear updates timed on the incremental index (default: 100000)\n";
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--rows") {
+            a.rows = std::stoull(need("--rows"));
+        } else if (key == "--cols") {
+            a.cols = std::stoull(need("--cols"));
+        } else if (key == "--degree") {
+            a.degree = std::stoull(need("--degree"));
+        } else if (key == "--seed") {
+            a.seed = std::stoull(need("--seed"));
+        } else if (key == "--mem-limit") {
+            a.mem_limit = std::size_t(std::stoull(need("--mem-limit"))) << 20;
+        } else if (key == "--repeats") {
+            a.repeats = std::max(1, std::stoi(need("--repeats")));
+        } else if (key == "--threads") {
+            a.threads = std::stoull(need("--threads"));
+        } else if (key == "--flips") {
+            a.flips = std::stoull(need("--flips"));
+        } else if (!key.empty() && key[0] == '-') {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        } else {
+            a.inputs = key;
+        }
+    }
+    a.threads = resolve_threads(a.threads);
+    if (a.cols < 2 || a.degree > a.cols) {
+        std::cerr << "Invalid cols/degree\n";
+        std::exit(2);
+    }
+    return true;
+}
+
+struct Case {
+    std::string name;
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    ColumnLists lists;
+    BinaryMatrix matrix;   // пустая, если битсеты не помещаются в лимит
+    bool has_matrix = false;
+};
+
+template<class F>
+static double median_us(int repeats, F&& body) {
+    std::vector<double> times;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::micro>(stop - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+static void report(const Case& c, const std::string& method, const std::string& outcome, double us) {
+    std::cout << std::left << std::setw(22) << c.name << std::setw(16) << method
+              << std::setw(34) << outcome;
+    if (us >= 0) std::cout << std::right << std::fixed << std::setprecision(1) << std::setw(12) << us << " us";
+    std::cout << "\n";
+}
+
+static void run_case(const Case& c, const Args& a) {
+    MatrixProfile p = profile_lists(c.lists, c.cols);
+    if (exceeds_pair_bound(c.rows, c.cols, p)) {
+        report(c, "bound", "1", 0.0);
+        return;
+    }
+
+    std::size_t bitset_bytes = c.rows * ((c.cols + 63) / 64) * 8;
+    if (!c.has_matrix) {
+        report(c, "bitset", "skipped: needs " + std::to_string(bitset_bytes >> 20) + " MiB", -1);
+    } else {
+        bool found = false;
+        double us = median_us(a.repeats, [&] { found = has_cycle_bitset(c.matrix); });
+        report(c, "bitset", found ? "1" : "0", us);
+        if (a.threads != 1) {
+            us = median_us(a.repeats, [&] { found = has_cycle_bitset(c.matrix, a.threads); });
+            report(c, "bitset x" + std::to_string(a.threads), found ? "1" : "0", us);
+        }
+    }
+
+    for (PairStore store : {PairStore::Marks, PairStore::Hash}) {
+        std::string method = std::string("pairs/") + store_name(store);
+        std::size_t bytes = pair_store_bytes(store, c.cols, p.row_pairs);
+        if (bytes > a.mem_limit) {
+            report(c, method, "skipped: needs " + std::to_string(bytes >> 20) + " MiB", -1);
+            continue;
+        }
+        bool found = false;
+        double us = median_us(a.repeats, [&] { found = has_cycle_pairs(c.lists, c.cols, store); });
+        report(c, method, std::string(found ? "1" : "0") + " (" + std::to_string(bytes >> 10) + " KiB)", us);
+        if (a.threads != 1) {
+            us = median_us(a.repeats, [&] { found = has_cycle_pairs(c.lists, c.cols, store, a.threads); });
+            report(c, method + " x" + std::to_string(a.threads), found ? "1" : "0", us);
+        }
+    }
+
+    // Инкрементальный индекс: время построения, затем среднее время
+    // одного set/clear случайного элемента
+    double index_bytes = p.row_pairs * 32;
+    if (index_bytes > double(a.mem_limit)) {
+        report(c, "incremental", "skipped: needs " + std::to_string(std::size_t(index_bytes) >> 20) + " MiB", -1);
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    IncrementalCycleIndex index(c.lists, c.cols);
+    double build_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    bool initial = index.has_cycle();
+
+    std::mt19937_64 rng(a.seed);
+    std::uniform_int_distribution<std::size_t> row(0, c.rows - 1), col(0, c.cols - 1);
+    start = std::chrono::steady_clock::now();
+    for (std::size_t k = 0; k < a.flips; k++) {
+        std::size_t i = row(rng), j = col(rng);
+        if (!index.set(i, j)) index.clear(i, j);
+    }
+    double flip_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                     double(std::max<std::size_t>(a.flips, 1));
+    std::ostringstream outcome;
+    outcome << (initial ? "1" : "0") << " (" << std::fixed << std::setprecision(0) << flip_ns << " ns/flip)";
+    report(c, "incremental", outcome.str(), build_us);
+}
+
+static ColumnLists lists_from_rows(const std::vector<std::vector<std::uint32_t>>& rows) {
+    ColumnLists lists;
+    lists.offsets.push_back(0);
+    for (const auto& r : rows) {
+        lists.columns.insert(lists.columns.end(), r.begin(), r.end());
+        lists.offsets.push_back(lists.columns.size());
+    }
+    return lists;
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+
+    std::vector<Case> cases;
+
+    // 1) Входы из репозитория
+    std::vector<fs::path> files;
+    if (fs::is_directory(a.inputs)) {
+        for (const auto& e : fs::directory_iterator(a.inputs))
+            if (e.is_regular_file()) files.push_back(e.path());
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& f : files) {
+        Case c;
+        c.name = f.filename().string();
+        try {
+            c.matrix = load_matrix(f.string()).bits;
+        } catch (const std::exception& e) {
+            std::cerr << "skip " << f.string() << ": " << e.what() << "\n";
+            continue;
+        }
+        c.rows = c.matrix.rows();
+        c.cols = c.matrix.cols();
+        c.lists = ColumnLists::from_matrix(c.matrix);
+        c.has_matrix = true;
+        cases.push_back(std::move(c));
+    }
+
+    // 2) Случайная разреженная: degree различных столбцов в каждой строке
+    {
+        std::mt19937_64 rng(a.seed);
+        std::uniform_int_distribution<std::uint32_t> col(0, std::uint32_t(a.cols - 1));
+        std::vector<std::vector<std::uint32_t>> rows(a.rows);
+        for (auto& r : rows) {
+            while (r.size() < a.degree) {
+                std::uint32_t c = col(rng);
+                if (std::find(r.begin(), r.end(), c) == r.end()) r.push_back(c);
+            }
+            std::sort(r.begin(), r.end());
+        }
+        Case c;
+        c.name = "random-sparse";
+        c.rows = a.rows;
+        c.cols = a.cols;
+        c.lists = lists_from_rows(rows);
+        cases.push_back(std::move(c));
+    }
+
+    // 3) Без циклов: строка i содержит столбцы i и i+1 (по модулю M) — все пары
+    //    различны, поэтому Pairs обязан просмотреть их все
+    {
+        std::vector<std::vector<std::uint32_t>> rows(a.rows);
+        for (std::size_t i = 0; i < a.rows; i++) {
+            std::uint32_t c1 = std::uint32_t(i % a.cols);
+            std::uint32_t c2 = std::uint32_t((i + 1) % a.cols);
+            rows[i] = {std::min(c1, c2), std::max(c1, c2)};
+        }
+        Case c;
+        c.name = "ring-acyclic";
+        c.rows = a.rows;
+        c.cols = a.cols;
+        c.lists = lists_from_rows(rows);
+        cases.push_back(std::move(c));
+    }
+
+    for (Case& c : cases) {
+        std::size_t bitset_bytes = c.rows * ((c.cols + 63) / 64) * 8;
+        if (!c.has_matrix && bitset_bytes <= a.mem_limit) {
+            c.matrix = BinaryMatrix(c.rows, c.cols);
+            for (std::size_t i = 0; i < c.rows; i++)
+                for (const std::uint32_t* j = c.lists.begin(i); j != c.lists.end(i); ++j) c.matrix.set(i, *j);
+            c.has_matrix = true;
+        }
+        run_case(c, a);
+    }
+    return 0;
+}
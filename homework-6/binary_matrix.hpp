@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if !defined(__GNUC__)
+#include <bitset>
+#endif
+
+inline unsigned popcount64(std::uint64_t x)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcountll(x));
+#else
+    return static_cast<unsigned>(std::bitset<64>(x).count());
+#endif
+}
+
+inline unsigned ctz64(std::uint64_t x)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+    unsigned n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Бинарная матрица N x M, строки упакованы в биты по 64 столбца на слово.
+// Хвост последнего слова строки всегда нулевой.
+class BinaryMatrix {
+public:
+    BinaryMatrix() = default;
+
+    BinaryMatrix(std::size_t rows, std::size_t cols)
+        : rows_(rows), cols_(cols), words_((cols + 63) / 64), bits_(rows * words_, 0) {}
+
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    std::size_t words_per_row() const { return words_; }
+
+    const std::uint64_t* row(std::size_t i) const { return bits_.data() + i * words_; }
+    std::uint64_t* row(std::size_t i) { return bits_.data() + i * words_; }
+
+    bool get(std::size_t i, std::size_t j) const {
+        return (row(i)[j / 64] >> (j % 64)) & 1;
+    }
+
+    void set(std::size_t i, std::size_t j, bool value = true) {
+        std::uint64_t mask = std::uint64_t(1) << (j % 64);
+        if (value) row(i)[j / 64] |= mask;
+        else row(i)[j / 64] &= ~mask;
+    }
+
+    std::size_t row_degree(std::size_t i) const {
+        const std::uint64_t* r = row(i);
+        std::size_t d = 0;
+        for (std::size_t w = 0; w < words_; w++) d += popcount64(r[w]);
+        return d;
+    }
+
+private:
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
+    std::size_t words_ = 0;
+    std::vector<std::uint64_t> bits_;
+};
+
+// Отсортированные списки столбцов с единицами для каждой строки (CSR).
+struct ColumnLists {
+    std::vector<std::size_t> offsets;   // rows + 1 элементов
+    std::vector<std::uint32_t> columns;
+
+    std::size_t rows() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    std::size_t degree(std::size_t i) const { return offsets[i + 1] - offsets[i]; }
+    const std::uint32_t* begin(std::size_t i) const { return columns.data() + offsets[i]; }
+    const std::uint32_t* end(std::size_t i) const { return columns.data() + offsets[i + 1]; }
+
+    static ColumnLists from_matrix(const BinaryMatrix& m) {
+        ColumnLists lists;
+        lists.offsets.resize(m.rows() + 1, 0);
+        for (std::size_t i = 0; i < m.rows(); i++)
+            lists.offsets[i + 1] = lists.offsets[i] + m.row_degree(i);
+
+        lists.columns.resize(lists.offsets.back());
+        std::uint32_t* out = lists.columns.data();
+        for (std::size_t i = 0; i < m.rows(); i++) {
+            const std::uint64_t* r = m.row(i);
+            for (std::size_t w = 0; w < m.words_per_row(); w++) {
+                for (std::uint64_t bits = r[w]; bits != 0; bits &= bits - 1)
+                    *out++ = static_cast<std::uint32_t>(w * 64 + ctz64(bits));
+            }
+        }
+        return lists;
+    }
+
+    BinaryMatrix to_matrix(std::size_t cols) const {
+        BinaryMatrix m(rows(), cols);
+        for (std::size_t i = 0; i < rows(); i++)
+            for (const std::uint32_t* c = begin(i); c != end(i); ++c) m.set(i, *c);
+        return m;
+    }
+};
@@ -0,0 +1,339 @@
+// Дифференциальная проверка и нагрузочный прогон решателя.
+//   1) Малые матрицы из генератора (все виды, разные размеры и плотности):
+//      каждый режим, хранилище, число потоков, вход через текст и через
+//      инкрементальный индекс сверяются с переборной эталонной проверкой;
+//      для acyclic/planted дополнительно проверяется сам генератор.
+//   2) Большие матрицы: время генерации, чтения текста и поиска, пропускная
+//      способность и пиковый RSS. Каждый случай выполняется в отдельном
+//      процессе, чтобы ru_maxrss относился только к нему.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "binary_matrix.hpp"
+#include "incremental.hpp"
+#include "matrix_gen.hpp"
+#include "matrix_io.hpp"
+#include "solver.hpp"
+
+namespace fs = std::filesystem;
+
+struct Args {
+    int small = 2000;           // число малых матриц
+    std::size_t threads = 4;
+    std::uint64_t seed = 1;
+    std::size_t mem_limit = std::size_t(1) << 30;
+    std::size_t text_limit = std::size_t(256) << 20;  // большие случаи крупнее не пишутся в файл
+    bool large = true;
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options]\n"
+        "Cross-checks all solver modes against brute force on small generated matrices,\n"
+        "then reports throughput and peak RSS on large ones.\n"
+        "Options:\n"
+        "  --small K         number of small matrices to cross-check (default: 2000)\n"
+        "  --threads T       thread count used for the parallel runs (default: 4)\n"
+        "  --seed X          base seed (default: 1)\n"
+        "  --mem-limit MIB   memory cap passed to the solver (default: 1024)\n"
+        "  --text-limit MIB  skip the text round trip for larger inputs (default: 256)\n"
+        "  --no-large        run the cross-check only\n";
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--small") {
+            a.small = std::stoi(need("--small"));
+        } else if (key == "--threads") {
+            a.threads = std::max<std::size_t>(2, std::stoull(need("--threads")));
+        } else if (key == "--seed") {
+            a.seed = std::stoull(need("--seed"));
+        } else if (key == "--mem-limit") {
+            a.mem_limit = std::size_t(std::stoull(need("--mem-limit"))) << 20;
+        } else if (key == "--text-limit") {
+            a.text_limit = std::size_t(std::stoull(need("--text-limit"))) << 20;
+        } else if (key == "--no-large") {
+            a.large = false;
+        } else {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        }
+    }
+    return true;
+}
+
+// Эталон: пересечение отсортированных списков для каждой пары строк
+static bool brute_force(const ColumnLists& lists) {
+    for (std::size_t a = 0; a < lists.rows(); a++) {
+        for (std::size_t b = a + 1; b < lists.rows(); b++) {
+            const std::uint32_t* x = lists.begin(a);
+            const std::uint32_t* y = lists.begin(b);
+            int common = 0;
+            while (x != lists.end(a) && y != lists.end(b) && common < 2) {
+                if (*x < *y) ++x;
+                else if (*y < *x) ++y;
+                else { common++; ++x; ++y; }
+            }
+            if (common >= 2) return true;
+        }
+    }
+    return false;
+}
+
+static bool is_witness(const ColumnLists& lists, const CycleWitness& w) {
+    auto has = [&](std::size_t i, std::size_t c) {
+        return i < lists.rows() && std::binary_search(lists.begin(i), lists.end(i), std::uint32_t(c));
+    };
+    return w.v1 < w.v2 && w.c1 < w.c2 &&
+           has(w.v1, w.c1) && has(w.v1, w.c2) && has(w.v2, w.c1) && has(w.v2, w.c2);
+}
+
+static void write_text(const ColumnLists& lists, std::size_t cols, const std::string& path) {
+    FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out) throw std::runtime_error("cannot create " + path);
+    std::fprintf(out, "%zu %zu\n", lists.rows(), cols);
+    std::string line(cols + 1, '0');
+    line[cols] = '\n';
+    for (std::size_t i = 0; i < lists.rows(); i++) {
+        for (const std::uint32_t* c = lists.begin(i); c != lists.end(i); ++c) line[*c] = '1';
+        std::fwrite(line.data(), 1, line.size(), out);
+        for (const std::uint32_t* c = lists.begin(i); c != lists.end(i); ++c) line[*c] = '0';
+    }
+    std::fclose(out);
+}
+
+struct Checker {
+    const Args& args;
+    std::string temp;
+    int checks = 0;
+    int failures = 0;
+
+    void expect(bool ok, const GenOptions& g, const std::string& what) {
+        checks++;
+        if (ok) return;
+        if (++failures <= 20) {
+            std::cout << "FAIL " << gen_kind_name(g.kind) << " " << g.rows << "x" << g.cols
+                      << " density " << g.density << " seed " << g.seed << ": " << what << "\n";
+        }
+    }
+
+    void check_result(const SolveResult& r, bool expected, const ColumnLists& lists, const GenOptions& g,
+                      const std::string& what) {
+        expect(r.has_cycle == expected, g, what + " answer");
+        if (r.has_witness) expect(is_witness(lists, r.witness), g, what + " witness");
+    }
+
+    void run(const GenOptions& g, bool text_round_trip) {
+        ColumnLists lists = generate_lists(g);
+        bool expected = brute_force(lists);
+        if (g.kind == GenKind::Acyclic) expect(!expected, g, "generator: acyclic matrix has a cycle");
+        if (g.kind == GenKind::Planted) expect(expected, g, "generator: planted cycle missing");
+
+        BinaryMatrix m = lists.to_matrix(g.cols);
+        for (SolverMode mode : {SolverMode::Auto, SolverMode::Bitset, SolverMode::Pairs}) {
+            for (PairStore store : {PairStore::Auto, PairStore::Marks, PairStore::Hash}) {
+                if (mode != SolverMode::Pairs && store != PairStore::Auto) continue;
+                for (std::size_t threads : {std::size_t(1), args.threads}) {
+                    for (bool witness : {false, true}) {
+                        SolverOptions o;
+                        o.mode = mode;
+                        o.store = store;
+                        o.threads = threads;
+                        o.witness = witness;
+                        std::string name = std::string(mode_name(mode)) + "/" + store_name(store) +
+                                           " x" + std::to_string(threads) + (witness ? " witness" : "");
+                        SolveResult r = solve(m, o);
+                        check_result(r, expected, lists, g, "bitset input " + name);
+                        if (witness) expect(r.has_witness == expected, g, "bitset input " + name + " has_witness");
+                        r = solve(lists, g.cols, o);
+                        check_result(r, expected, lists, g, "lists input " + name);
+                        if (witness) expect(r.has_witness == expected, g, "lists input " + name + " has_witness");
+                    }
+                }
+            }
+        }
+
+        // Прямые вызовы, минуя границу Дирихле
+        for (std::size_t threads : {std::size_t(1), args.threads}) {
+            CycleWitness w1, w2, w3;
+            expect(has_cycle_bitset(m, threads, &w1) == expected, g, "has_cycle_bitset");
+            expect(has_cycle_pairs(lists, g.cols, PairStore::Marks, threads, &w2) == expected, g, "pairs/marks");
+            expect(has_cycle_pairs(lists, g.cols, PairStore::Hash, threads, &w3) == expected, g, "pairs/hash");
+            if (expected) {
+                expect(is_witness(lists, w1) && is_witness(lists, w2) && is_witness(lists, w3), g, "direct witness");
+            }
+        }
+
+        IncrementalCycleIndex index(lists, g.cols);
+        CycleWitness w;
+        expect(index.has_cycle() == expected, g, "incremental");
+        expect(index.find_witness(w) == expected && (!expected || is_witness(lists, w)), g, "incremental witness");
+
+        if (text_round_trip) {
+            write_text(lists, g.cols, temp);
+            for (MatrixLayout layout : {MatrixLayout::Bitset, MatrixLayout::Lists}) {
+                LoadedMatrix loaded = load_matrix(temp, layout);
+                bool same = loaded.layout == MatrixLayout::Bitset
+                    ? ColumnLists::from_matrix(loaded.bits).columns == lists.columns
+                    : loaded.stopped_by_bound || loaded.lists.columns == lists.columns;
+                expect(same, g, std::string("text round trip ") + layout_name(layout));
+            }
+        }
+    }
+};
+
+static void cross_check(const Args& a, Checker& checker) {
+    std::mt19937_64 rng(a.seed);
+    auto uniform = [&](std::size_t lo, std::size_t hi) {
+        return std::uniform_int_distribution<std::size_t>(lo, hi)(rng);
+    };
+
+    for (int it = 0; it < a.small; it++) {
+        GenOptions g;
+        g.seed = a.seed * 1000003 + std::uint64_t(it);
+        g.kind = static_cast<GenKind>(it % 3);
+        // Каждая сотая матрица достаточно велика, чтобы включился параллельный поиск
+        bool medium = it % 100 == 99;
+        g.rows = medium ? uniform(1024, 2500) : uniform(1, 48);
+        g.cols = medium ? uniform(64, 3000) : uniform(1, 48);
+        if (g.kind == GenKind::Random) {
+            double scale = medium ? 3.0 / double(g.cols) : 1.0;
+            g.density = std::min(1.0, scale * std::pow(0.5, double(uniform(0, 6))));
+        } else {
+            if (g.rows < 2 || g.cols < 2) g.kind = GenKind::Acyclic;
+            g.density = uniform(0, 1) ? 0.0 : 1.0 / double(uniform(2, 12));
+        }
+        checker.run(g, it % 10 == 0);
+    }
+}
+
+// Один большой случай; выполняется в дочернем процессе
+static void run_large(const Args& a, const std::string& temp, const GenOptions& g) {
+    using clock = std::chrono::steady_clock;
+    auto ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    auto start = clock::now();
+    ColumnLists lists = generate_lists(g);
+    double gen_ms = ms(clock::now() - start);
+    MatrixProfile p = profile_lists(lists, g.cols);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << gen_kind_name(g.kind) << " " << g.rows << " x " << g.cols << ": ones " << p.ones
+              << ", row pairs " << std::setprecision(0) << p.row_pairs << std::setprecision(1)
+              << ", generated in " << gen_ms << " ms\n";
+
+    double text_bytes = double(g.rows) * double(g.cols + 1);
+    if (text_bytes <= double(a.text_limit)) {
+        write_text(lists, g.cols, temp);
+        start = clock::now();
+        LoadedMatrix loaded = load_matrix(temp, MatrixLayout::Auto, a.mem_limit);
+        double load_ms = ms(clock::now() - start);
+        fs::remove(temp);
+        std::cout << "  load (" << layout_name(loaded.layout) << "): " << load_ms << " ms, "
+                  << text_bytes / double(1 << 20) / (load_ms / 1000.0) << " MiB/s\n";
+    } else {
+        std::cout << "  load: skipped, text would be " << std::size_t(text_bytes) / (1 << 20) << " MiB\n";
+    }
+
+    for (std::size_t threads : {std::size_t(1), a.threads}) {
+        SolverOptions o;
+        o.threads = threads;
+        o.mem_limit = a.mem_limit;
+        start = clock::now();
+        SolveResult r = solve(lists, g.cols, o);
+        double solve_ms = ms(clock::now() - start);
+        std::cout << "  solve x" << threads << ": " << (r.has_cycle ? 1 : 0) << " via " << mode_name(r.mode);
+        if (r.mode == SolverMode::Pairs && !r.by_bound) std::cout << "/" << store_name(r.store);
+        if (r.by_bound) std::cout << " (bound)";
+        std::cout << ", " << solve_ms << " ms";
+        if (!r.by_bound)
+            std::cout << ", " << std::setprecision(0) << p.row_pairs / (solve_ms / 1000.0) / 1e6
+                      << std::setprecision(1) << " M pairs/s";
+        std::cout << "\n";
+    }
+    std::cout.flush();
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+
+    std::string temp = (fs::temp_directory_path() / ("four_cycle_check_" + std::to_string(::getpid()))).string();
+    Checker checker{a, temp};
+    cross_check(a, checker);
+    fs::remove(temp);
+    std::cout << "cross-check: " << a.small << " matrices, " << checker.checks << " checks, "
+              << checker.failures << " failures\n";
+    if (checker.failures != 0) return 1;
+    if (!a.large) return 0;
+
+    std::vector<GenOptions> cases;
+    auto add = [&](GenKind kind, std::size_t rows, std::size_t cols, double density) {
+        GenOptions g;
+        g.kind = kind;
+        g.rows = rows;
+        g.cols = cols;
+        g.density = density;
+        g.seed = a.seed;
+        cases.push_back(g);
+    };
+    add(GenKind::Acyclic, 12883, 12883, 0);         // PG(2, 113): все C(M, 2) пар заняты
+    add(GenKind::Planted, 12883, 12883, 0);
+    add(GenKind::Acyclic, 200000, 200000, 1.0 / 7); // блоки PG(2, 7) по диагонали
+    add(GenKind::Random, 200000, 200000, 2e-5);
+
+    for (const GenOptions& g : cases) {
+        std::cout.flush();  // иначе буфер продублируется в дочернем процессе
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            std::perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            try {
+                run_large(a, temp, g);
+            } catch (const std::exception& e) {
+                std::cout << "  error: " << e.what() << "\n";
+                std::cout.flush();
+                std::_Exit(1);
+            }
+            std::_Exit(0);
+        }
+
+        int status = 0;
+        struct rusage usage {};
+        ::wait4(pid, &status, 0, &usage);
+        std::cout << "  peak RSS " << usage.ru_maxrss / 1024 << " MiB";
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) std::cout << " (case failed)";
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Генератор входных данных: матрица N x M в формате задачи.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "matrix_gen.hpp"
+
+struct Args {
+    std::string out;  // пусто => stdout
+    GenOptions gen;
+    bool verbose = false;
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options]\n"
+        "Writes an N x M binary matrix in the homework-6 input format.\n"
+        "Options:\n"
+        "  --rows N          number of rows (required)\n"
+        "  --cols M          number of columns (required)\n"
+        "  --kind K          random | acyclic | planted (default: random)\n"
+        "                    acyclic: projective plane PG(2, q) incidence blocks, no 4-cycles;\n"
+        "                    planted: acyclic plus one 2 x 2 block of ones at a random place\n"
+        "  --density P       random: probability of a one (default: 0.01);\n"
+        "                    acyclic/planted: picks q ~ 1/P, 0 = densest plane fitting min(N, M)\n"
+        "  --seed X          random seed (default: 1)\n"
+        "  --out FILE        output file (default: stdout)\n"
+        "  --verbose         print the construction details to stderr\n"
+        "\nExamples:\n"
+        "  " << prog << " --rows 200000 --cols 200000 --density 0.00002 --seed 7 --out random.txt\n"
+        "  " << prog << " --rows 12883 --cols 12883 --kind acyclic --out worst.txt\n";
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    bool density_set = false;
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--rows") {
+            a.gen.rows = std::stoull(need("--rows"));
+        } else if (key == "--cols") {
+            a.gen.cols = std::stoull(need("--cols"));
+        } else if (key == "--kind") {
+            if (!parse_gen_kind(need("--kind"), a.gen.kind)) {
+                std::cerr << "Invalid value for --kind\n";
+                std::exit(2);
+            }
+        } else if (key == "--density") {
+            a.gen.density = std::stod(need("--density"));
+            density_set = true;
+        } else if (key == "--seed") {
+            a.gen.seed = std::stoull(need("--seed"));
+        } else if (key == "--out") {
+            a.out = need("--out");
+        } else if (key == "--verbose") {
+            a.verbose = true;
+        } else {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        }
+    }
+    if (a.gen.rows == 0 || a.gen.cols == 0) {
+        std::cerr << "--rows and --cols are required\n";
+        std::exit(2);
+    }
+    if (!density_set && a.gen.kind == GenKind::Random) a.gen.density = 0.01;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+
+    std::optional<MatrixGenerator> gen;
+    try {
+        gen.emplace(a.gen);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Invalid parameters: " << e.what() << "\n";
+        return 2;
+    }
+
+    FILE* out = a.out.empty() ? stdout : std::fopen(a.out.c_str(), "wb");
+    if (!out) {
+        std::perror(a.out.c_str());
+        return 1;
+    }
+    static char buffer[1 << 20];
+    std::setvbuf(out, buffer, _IOFBF, sizeof(buffer));
+
+    // Строка собирается в буфере из '0' и после записи возвращается к нему
+    std::string line(a.gen.cols + 1, '0');
+    line[a.gen.cols] = '\n';
+    std::vector<std::uint32_t> columns;
+    std::uint64_t ones = 0;
+
+    std::fprintf(out, "%zu %zu\n", a.gen.rows, a.gen.cols);
+    for (std::size_t i = 0; i < a.gen.rows; i++) {
+        gen->next_row(columns);
+        for (std::uint32_t c : columns) line[c] = '1';
+        std::fwrite(line.data(), 1, line.size(), out);
+        for (std::uint32_t c : columns) line[c] = '0';
+        ones += columns.size();
+    }
+
+    bool failed = std::ferror(out) != 0;
+    if (out != stdout) failed = std::fclose(out) != 0 || failed;
+    else failed = std::fflush(out) != 0 || failed;
+    if (failed) {
+        std::cerr << "Write error\n";
+        return 1;
+    }
+
+    if (a.verbose) {
+        std::cerr << gen_kind_name(a.gen.kind) << " " << a.gen.rows << " x " << a.gen.cols
+                  << ", ones " << ones;
+        if (a.gen.kind != GenKind::Random)
+            std::cerr << ", PG(2, " << gen->plane_order() << ") blocks of " << gen->plane_size();
+        if (a.gen.kind == GenKind::Planted)
+            std::cerr << ", cycle at rows " << gen->planted_row(0) + 1 << ", " << gen->planted_row(1) + 1
+                      << " cols " << gen->planted_col(0) + 1 << ", " << gen->planted_col(1) + 1;
+        std::cerr << "\n";
+    }
+    return 0;
+}
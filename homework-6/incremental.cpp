@@ -0,0 +1,79 @@
+#include "incremental.hpp"
+
+#include <algorithm>
+
+IncrementalCycleIndex::IncrementalCycleIndex(std::size_t rows, std::size_t cols)
+    : cols_(cols), rows_(rows), counts_(cols) {}
+
+IncrementalCycleIndex::IncrementalCycleIndex(const ColumnLists& lists, std::size_t cols)
+    : cols_(cols), rows_(lists.rows()), counts_(cols) {
+    for (std::size_t i = 0; i < lists.rows(); i++) {
+        rows_[i].reserve(lists.degree(i));
+        for (const std::uint32_t* c = lists.begin(i); c != lists.end(i); ++c) set(i, *c);
+    }
+}
+
+bool IncrementalCycleIndex::get(std::size_t i, std::size_t j) const {
+    return std::binary_search(rows_[i].begin(), rows_[i].end(), std::uint32_t(j));
+}
+
+bool IncrementalCycleIndex::set(std::size_t i, std::size_t j) {
+    std::vector<std::uint32_t>& row = rows_[i];
+    std::uint32_t c = std::uint32_t(j);
+    auto pos = std::lower_bound(row.begin(), row.end(), c);
+    if (pos != row.end() && *pos == c) return false;
+
+    for (std::uint32_t other : row) {
+        std::uint32_t c1 = std::min(c, other), c2 = std::max(c, other);
+        if (counts_.add(c1, c2) == 2) {
+            repeated_pairs_++;
+            remember_repeated(c1, c2);
+        }
+    }
+    row.insert(pos, c);
+    return true;
+}
+
+bool IncrementalCycleIndex::clear(std::size_t i, std::size_t j) {
+    std::vector<std::uint32_t>& row = rows_[i];
+    std::uint32_t c = std::uint32_t(j);
+    auto pos = std::lower_bound(row.begin(), row.end(), c);
+    if (pos == row.end() || *pos != c) return false;
+
+    row.erase(pos);
+    for (std::uint32_t other : row) {
+        if (counts_.remove(std::min(c, other), std::max(c, other)) == 1) repeated_pairs_--;
+    }
+    return true;
+}
+
+void IncrementalCycleIndex::remember_repeated(std::uint32_t c1, std::uint32_t c2) {
+    repeated_.emplace_back(c1, c2);
+    if (repeated_.size() <= 2 * repeated_pairs_ + 64) return;
+
+    // Чистим устаревшие и дубли, чтобы список не рос при частых перещёлкиваниях
+    std::sort(repeated_.begin(), repeated_.end());
+    repeated_.erase(std::unique(repeated_.begin(), repeated_.end()), repeated_.end());
+    repeated_.erase(std::remove_if(repeated_.begin(), repeated_.end(),
+                                   [&](const auto& p) { return counts_.count(p.first, p.second) < 2; }),
+                    repeated_.end());
+}
+
+bool IncrementalCycleIndex::find_witness(CycleWitness& witness) {
+    while (!repeated_.empty() && counts_.count(repeated_.back().first, repeated_.back().second) < 2)
+        repeated_.pop_back();
+    if (repeated_.empty()) return false;
+
+    auto [c1, c2] = repeated_.back();
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < rows_.size() && found < 2; i++) {
+        if (!std::binary_search(rows_[i].begin(), rows_[i].end(), c1) ||
+            !std::binary_search(rows_[i].begin(), rows_[i].end(), c2))
+            continue;
+        if (found++ == 0) witness.v1 = i;
+        else witness.v2 = i;
+    }
+    witness.c1 = c1;
+    witness.c2 = c2;
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "binary_matrix.hpp"
+#include "pair_store.hpp"
+#include "solver.hpp"
+
+// Матрица, которую меняют по одному элементу, с мгновенным ответом на вопрос
+// «есть ли сейчас цикл длины 4». Для каждой пары столбцов хранится, в скольких
+// строках она встречается: цикл есть ровно тогда, когда хотя бы одна пара
+// встречается дважды. set/clear в строке степени d меняют d счётчиков,
+// has_cycle() — O(1), полный поиск заново не нужен.
+//
+// Память — около 32 байт на различную пару столбцов в строках плюс списки
+// столбцов строк, то есть порядка sum C(deg(row), 2).
+class IncrementalCycleIndex {
+public:
+    IncrementalCycleIndex(std::size_t rows, std::size_t cols);
+    IncrementalCycleIndex(const ColumnLists& lists, std::size_t cols);
+
+    std::size_t rows() const { return rows_.size(); }
+    std::size_t cols() const { return cols_; }
+    bool get(std::size_t i, std::size_t j) const;
+
+    // false, если элемент уже имел нужное значение (счётчики не менялись)
+    bool set(std::size_t i, std::size_t j);
+    bool clear(std::size_t i, std::size_t j);
+
+    bool has_cycle() const { return repeated_pairs_ != 0; }
+    // Сколько пар столбцов встречается хотя бы в двух строках
+    std::size_t repeated_pairs() const { return repeated_pairs_; }
+
+    // Какой-нибудь из текущих циклов; false, если циклов нет.
+    // Стоит O(N log d) на поиск второй строки с повторной парой.
+    bool find_witness(CycleWitness& witness);
+
+private:
+    void remember_repeated(std::uint32_t c1, std::uint32_t c2);
+
+    std::size_t cols_;
+    std::vector<std::vector<std::uint32_t>> rows_;  // отсортированные столбцы с единицами
+    PairCountMap counts_;
+    std::size_t repeated_pairs_ = 0;
+    // Пары, у которых счётчик когда-то дошёл до 2. Устаревшие (счётчик уже
+    // меньше) отбрасываются лениво в find_witness и при разрастании списка.
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> repeated_;
+};
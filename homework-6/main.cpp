@@ -0,0 +1,135 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "binary_matrix.hpp"
+#include "matrix_io.hpp"
+#include "solver.hpp"
+
+struct Args {
+    std::string path;  // пусто => stdin
+    MatrixLayout layout = MatrixLayout::Auto;
+    SolverOptions solver;
+    bool verbose = false;
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options] [path]\n"
+        "Reads an N x M binary matrix and prints 1 if it contains a 4-cycle, 0 otherwise.\n"
+        "Options:\n"
+        "  --layout L        auto | bitset | lists, in-memory form of the matrix;\n"
+        "                    auto keeps bitsets if they fit into --mem-limit (default: auto)\n"
+        "  --mode MODE       auto | bitset | pairs (default: auto)\n"
+        "  --pair-store S    auto | marks | hash, storage for the pairs mode (default: auto)\n"
+        "  --mem-limit MIB   memory cap for bitsets and pair storage (default: 1024)\n"
+        "  --threads T       worker threads for the search, 0 = all cores (default: 1)\n"
+        "  --witness         if a cycle exists, also print it as \"v1 v2 c1 c2\"\n"
+        "                    (1-based rows v1 < v2 and columns c1 < c2)\n"
+        "  --verbose         print chosen mode and matrix profile to stderr\n";
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--layout") {
+            if (i + 1 >= argc || !parse_layout(argv[++i], a.layout)) {
+                std::cerr << "Invalid value for --layout\n";
+                std::exit(2);
+            }
+        } else if (key == "--mode") {
+            if (i + 1 >= argc || !parse_mode(argv[++i], a.solver.mode)) {
+                std::cerr << "Invalid value for --mode\n";
+                std::exit(2);
+            }
+        } else if (key == "--pair-store") {
+            if (i + 1 >= argc || !parse_store(argv[++i], a.solver.store)) {
+                std::cerr << "Invalid value for --pair-store\n";
+                std::exit(2);
+            }
+        } else if (key == "--mem-limit") {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for --mem-limit\n";
+                std::exit(2);
+            }
+            a.solver.mem_limit = std::size_t(std::stoull(argv[++i])) << 20;
+        } else if (key == "--threads") {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for --threads\n";
+                std::exit(2);
+            }
+            a.solver.threads = std::size_t(std::stoull(argv[++i]));
+        } else if (key == "--witness") {
+            a.solver.witness = true;
+        } else if (key == "--verbose") {
+            a.verbose = true;
+        } else if (!key.empty() && key[0] == '-') {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        } else {
+            a.path = key;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+
+    auto start = std::chrono::steady_clock::now();
+    LoadedMatrix matrix;
+    try {
+        matrix = load_matrix(a.path, a.layout, a.solver.mem_limit);
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid input: " << e.what() << "\n";
+        return 1;
+    }
+    auto loaded = std::chrono::steady_clock::now();
+
+    SolveResult result;
+    // Если чтение остановлено по границе, цикл есть уже среди прочитанных
+    // строк — свидетеля ищем в них
+    if (matrix.stopped_by_bound && !a.solver.witness) {
+        result.has_cycle = true;
+        result.mode = a.solver.mode;
+        result.by_bound = true;
+    } else if (matrix.layout == MatrixLayout::Bitset) {
+        result = solve(matrix.bits, a.solver);
+    } else {
+        try {
+            result = solve(matrix.lists, matrix.cols, a.solver);
+        } catch (const std::exception& e) {
+            std::cerr << "Cannot solve: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    auto solved = std::chrono::steady_clock::now();
+
+    if (a.verbose) {
+        using ms = std::chrono::duration<double, std::milli>;
+        double load_ms = ms(loaded - start).count();
+        double input_mib = double(matrix.rows) * double(matrix.cols + 1) / double(1 << 20);
+        std::cerr << "matrix " << matrix.rows << " x " << matrix.cols
+                  << ", layout " << layout_name(matrix.layout)
+                  << ", load " << load_ms << " ms (~" << input_mib / (load_ms / 1000.0) << " MiB/s)"
+                  << ", solve " << ms(solved - loaded).count() << " ms\n";
+        std::cerr << "mode " << mode_name(result.mode);
+        if (result.mode == SolverMode::Pairs && !result.by_bound) std::cerr << " (" << store_name(result.store) << ")";
+        if (result.by_bound) std::cerr << " (decided by pair-count bound)";
+        if (result.fell_back) std::cerr << " (pair storage exceeds --mem-limit, fell back)";
+        if (!result.by_bound && result.threads > 1) std::cerr << ", " << result.threads << " threads";
+        std::cerr << "\n";
+    }
+    std::cout << (result.has_cycle ? 1 : 0) << "\n";
+    if (result.has_witness) {
+        const CycleWitness& w = result.witness;
+        std::cout << w.v1 + 1 << " " << w.v2 + 1 << " " << w.c1 + 1 << " " << w.c2 + 1 << "\n";
+    }
+    return 0;
+}
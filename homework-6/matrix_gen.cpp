@@ -0,0 +1,166 @@
+#include "matrix_gen.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+const char* gen_kind_name(GenKind kind) {
+    switch (kind) {
+    case GenKind::Random: return "random";
+    case GenKind::Acyclic: return "acyclic";
+    case GenKind::Planted: return "planted";
+    }
+    return "?";
+}
+
+bool parse_gen_kind(const std::string& name, GenKind& kind) {
+    if (name == "random") kind = GenKind::Random;
+    else if (name == "acyclic") kind = GenKind::Acyclic;
+    else if (name == "planted") kind = GenKind::Planted;
+    else return false;
+    return true;
+}
+
+static bool is_prime(unsigned n) {
+    if (n < 2) return false;
+    for (unsigned d = 2; d * d <= n; d++)
+        if (n % d == 0) return false;
+    return true;
+}
+
+static std::size_t plane_points(std::uint64_t q) {
+    return static_cast<std::size_t>(q * q + q + 1);
+}
+
+// Наибольшее простое q <= limit с блоком не больше bound (но не меньше 2:
+// PG(2, 2) с блоком 7 x 7 при необходимости просто обрезается)
+static unsigned choose_order(double limit, std::size_t bound) {
+    unsigned q = 2;
+    for (unsigned p = 3; p <= limit && plane_points(p) <= bound; p++)
+        if (is_prime(p)) q = p;
+    return q;
+}
+
+MatrixGenerator::MatrixGenerator(const GenOptions& options)
+    : options_(options), rng_(options.seed) {
+    if (options_.rows < 1 || options_.cols < 1)
+        throw std::invalid_argument("rows and cols must be >= 1");
+    if (options_.cols > 0xFFFFFFFFull)
+        throw std::invalid_argument("cols must fit into 32 bits");
+    if (options_.density < 0 || options_.density > 1)
+        throw std::invalid_argument("density must be in [0, 1]");
+    if (options_.kind == GenKind::Random) return;
+
+    std::size_t bound = std::max<std::size_t>(std::min(options_.rows, options_.cols), 7);
+    double limit = options_.density > 0 ? 1.0 / options_.density : double(bound);
+    q_ = choose_order(limit, bound);
+    plane_ = plane_points(q_);
+    // inv(x) = -(q / x) * inv(q mod x) (mod q)
+    inverse_.assign(q_, 0);
+    inverse_[1] = 1;
+    for (std::uint64_t x = 2; x < q_; x++)
+        inverse_[x] = std::uint32_t((q_ - q_ / x) * inverse_[q_ % x] % q_);
+
+    if (options_.kind == GenKind::Planted) {
+        if (options_.rows < 2 || options_.cols < 2)
+            throw std::invalid_argument("planted cycle needs at least 2 rows and 2 cols");
+        std::uniform_int_distribution<std::size_t> row(0, options_.rows - 1);
+        std::uniform_int_distribution<std::uint32_t> col(0, std::uint32_t(options_.cols - 1));
+        do {
+            planted_rows_[0] = row(rng_);
+            planted_rows_[1] = row(rng_);
+        } while (planted_rows_[0] == planted_rows_[1]);
+        do {
+            planted_cols_[0] = col(rng_);
+            planted_cols_[1] = col(rng_);
+        } while (planted_cols_[0] == planted_cols_[1]);
+        std::sort(planted_rows_, planted_rows_ + 2);
+        std::sort(planted_cols_, planted_cols_ + 2);
+    }
+}
+
+void MatrixGenerator::next_row(std::vector<std::uint32_t>& columns) {
+    columns.clear();
+    std::size_t i = next_++;
+    if (options_.kind == GenKind::Random) {
+        random_row(columns);
+        return;
+    }
+
+    plane_row(i, columns);
+    if (options_.kind == GenKind::Planted && (i == planted_rows_[0] || i == planted_rows_[1])) {
+        for (std::uint32_t c : planted_cols_) {
+            auto pos = std::lower_bound(columns.begin(), columns.end(), c);
+            if (pos == columns.end() || *pos != c) columns.insert(pos, c);
+        }
+    }
+}
+
+// Расстояние до следующей единицы распределено геометрически, поэтому
+// работа пропорциональна числу единиц, а не M.
+void MatrixGenerator::random_row(std::vector<std::uint32_t>& columns) {
+    double p = options_.density;
+    if (p <= 0) return;
+    if (p >= 1) {
+        for (std::size_t j = 0; j < options_.cols; j++) columns.push_back(std::uint32_t(j));
+        return;
+    }
+    std::geometric_distribution<std::uint64_t> gap(p);
+    for (std::uint64_t j = gap(rng_); j < options_.cols; j += gap(rng_) + 1)
+        columns.push_back(std::uint32_t(j));
+}
+
+// Прямые и точки PG(2, q) нумеруются одинаково по нормированным однородным
+// координатам: (1, y, z) -> y * q + z, (0, 1, z) -> q^2 + z, (0, 0, 1) -> q^2 + q.
+// Точка (x, y, z) лежит на прямой (a, b, c), если a x + b y + c z = 0 (mod q).
+void MatrixGenerator::plane_row(std::size_t i, std::vector<std::uint32_t>& columns) {
+    const std::uint64_t q = q_;
+    std::size_t base = i / plane_ * plane_;
+    if (base >= options_.cols) return;
+
+    std::uint64_t line = i % plane_;
+    std::uint64_t a, b, c;
+    if (line < q * q) {
+        a = 1; b = line / q; c = line % q;
+    } else if (line < q * q + q) {
+        a = 0; b = 1; c = line - q * q;
+    } else {
+        a = 0; b = 0; c = 1;
+    }
+
+    auto add = [&](std::uint64_t point) {
+        if (base + point < options_.cols) columns.push_back(std::uint32_t(base + point));
+    };
+    auto neg = [&](std::uint64_t x) { return (q - x % q) % q; };
+
+    // Точки (1, y, z): a + b y + c z = 0
+    if (c != 0) {
+        for (std::uint64_t y = 0; y < q; y++) add(y * q + neg(a + b * y) * inverse_[c] % q);
+    } else if (b != 0) {
+        std::uint64_t y = neg(a) * inverse_[b] % q;
+        for (std::uint64_t z = 0; z < q; z++) add(y * q + z);
+    }
+    // Точки (0, 1, z): b + c z = 0
+    if (c != 0) {
+        add(q * q + neg(b) * inverse_[c] % q);
+    } else if (b == 0) {
+        for (std::uint64_t z = 0; z < q; z++) add(q * q + z);
+    }
+    // Точка (0, 0, 1)
+    if (c == 0) add(q * q + q);
+
+    std::sort(columns.begin(), columns.end());
+}
+
+ColumnLists generate_lists(const GenOptions& options) {
+    MatrixGenerator gen(options);
+    ColumnLists lists;
+    lists.offsets.reserve(gen.rows() + 1);
+    lists.offsets.push_back(0);
+    std::vector<std::uint32_t> row;
+    for (std::size_t i = 0; i < gen.rows(); i++) {
+        gen.next_row(row);
+        lists.columns.insert(lists.columns.end(), row.begin(), row.end());
+        lists.offsets.push_back(lists.columns.size());
+    }
+    return lists;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "binary_matrix.hpp"
+
+// Вид генерируемой матрицы.
+//   Random  — каждая клетка равна 1 с вероятностью density;
+//   Acyclic — матрица инцидентности прямых и точек проективной плоскости
+//             PG(2, q): две прямые пересекаются ровно в одной точке, так что
+//             циклов длины 4 нет, а единиц почти максимум возможного (~M^1.5).
+//             Это худший случай для поиска: ответ 0, и просмотреть нужно всё.
+//             Блок (q^2 + q + 1)^2 повторяется по диагонали и обрезается до N x M;
+//   Planted — Acyclic плюс одна подматрица 2 x 2 из единиц в случайном месте.
+enum class GenKind { Random, Acyclic, Planted };
+
+const char* gen_kind_name(GenKind kind);
+bool parse_gen_kind(const std::string& name, GenKind& kind);
+
+struct GenOptions {
+    GenKind kind = GenKind::Random;
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    // Random: вероятность единицы. Acyclic/Planted: 0 — самая плотная
+    // плоскость, помещающаяся в min(N, M); иначе q ~ 1 / density
+    // (доля единиц в строке блока равна (q + 1) / (q^2 + q + 1)).
+    double density = 0;
+    std::uint64_t seed = 1;
+};
+
+// Порождает матрицу построчно, не держа её в памяти целиком.
+// Бросает std::invalid_argument на недопустимых параметрах.
+class MatrixGenerator {
+public:
+    explicit MatrixGenerator(const GenOptions& options);
+
+    std::size_t rows() const { return options_.rows; }
+    std::size_t cols() const { return options_.cols; }
+
+    // Порядок плоскости q и размер её блока q^2 + q + 1 (для Acyclic/Planted)
+    unsigned plane_order() const { return q_; }
+    std::size_t plane_size() const { return plane_; }
+
+    // Где вставлен цикл (для Planted): строки r1 < r2, столбцы c1 < c2
+    std::size_t planted_row(int k) const { return planted_rows_[k]; }
+    std::uint32_t planted_col(int k) const { return planted_cols_[k]; }
+
+    // Отсортированные столбцы с единицами следующей строки
+    void next_row(std::vector<std::uint32_t>& columns);
+
+private:
+    void random_row(std::vector<std::uint32_t>& columns);
+    void plane_row(std::size_t i, std::vector<std::uint32_t>& columns);
+
+    GenOptions options_;
+    std::mt19937_64 rng_;
+    std::size_t next_ = 0;
+
+    unsigned q_ = 0;
+    std::size_t plane_ = 0;
+    std::vector<std::uint32_t> inverse_;  // обратные по модулю q
+
+    std::size_t planted_rows_[2] = {0, 0};
+    std::uint32_t planted_cols_[2] = {0, 0};
+};
+
+// Вся матрица сразу в виде списков столбцов
+ColumnLists generate_lists(const GenOptions& options);
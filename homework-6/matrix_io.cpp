@@ -0,0 +1,337 @@
+#include "matrix_io.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+const char* layout_name(MatrixLayout layout) {
+    switch (layout) {
+    case MatrixLayout::Auto: return "auto";
+    case MatrixLayout::Bitset: return "bitset";
+    case MatrixLayout::Lists: return "lists";
+    }
+    return "?";
+}
+
+bool parse_layout(const std::string& name, MatrixLayout& layout) {
+    if (name == "auto") layout = MatrixLayout::Auto;
+    else if (name == "bitset") layout = MatrixLayout::Bitset;
+    else if (name == "lists") layout = MatrixLayout::Lists;
+    else return false;
+    return true;
+}
+
+namespace {
+
+std::runtime_error system_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+// Непрерывное окно входных байт. ensure(n) гарантирует n байт от текущей
+// позиции, если вход не кончился раньше.
+class ByteSource {
+public:
+    virtual ~ByteSource() = default;
+
+    const char* data() const { return pos_; }
+    std::size_t available() const { return std::size_t(end_ - pos_); }
+    virtual bool ensure(std::size_t n) = 0;
+    virtual void advance(std::size_t n) { pos_ += n; }
+
+protected:
+    const char* pos_ = nullptr;
+    const char* end_ = nullptr;
+};
+
+// Весь файл отображён в память; прочитанные страницы периодически
+// отпускаются, чтобы RSS не рос до размера входа.
+class MappedFile : public ByteSource {
+public:
+    MappedFile(int fd, std::size_t size) : size_(size) {
+        if (size_ == 0) return;
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) throw system_error("mmap");
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+        base_ = static_cast<const char*>(p);
+        pos_ = released_ = base_;
+        end_ = base_ + size_;
+    }
+
+    ~MappedFile() override {
+        if (base_) ::munmap(const_cast<char*>(base_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool ensure(std::size_t n) override { return available() >= n; }
+
+    void advance(std::size_t n) override {
+        pos_ += n;
+        if (std::size_t(pos_ - released_) >= kReleaseStep) {
+            std::size_t page = std::size_t(::sysconf(_SC_PAGESIZE));
+            std::size_t len = std::size_t(pos_ - released_) / page * page;
+            ::madvise(const_cast<char*>(released_), len, MADV_DONTNEED);
+            released_ += len;
+        }
+    }
+
+private:
+    static constexpr std::size_t kReleaseStep = std::size_t(64) << 20;
+
+    const char* base_ = nullptr;
+    const char* released_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Поток (stdin, pipe) читается блоками; неразобранный хвост переносится
+// в начало буфера перед следующим read().
+class StreamSource : public ByteSource {
+public:
+    explicit StreamSource(int fd) : fd_(fd), buf_(new char[kChunk]), capacity_(kChunk) {
+        pos_ = end_ = buf_.get();
+    }
+
+    bool ensure(std::size_t n) override {
+        while (available() < n && !eof_) refill(n);
+        return available() >= n;
+    }
+
+private:
+    static constexpr std::size_t kChunk = std::size_t(16) << 20;
+
+    void refill(std::size_t need) {
+        std::size_t tail = available();
+        if (capacity_ < need) {
+            // Строка длиннее буфера: заводим больший и переносим хвост туда
+            std::size_t capacity = std::max(need, capacity_ * 2);
+            std::unique_ptr<char[]> bigger(new char[capacity]);
+            std::memcpy(bigger.get(), pos_, tail);
+            buf_ = std::move(bigger);
+            capacity_ = capacity;
+        } else {
+            std::memmove(buf_.get(), pos_, tail);
+        }
+
+        ssize_t got;
+        do {
+            got = ::read(fd_, buf_.get() + tail, capacity_ - tail);
+        } while (got < 0 && errno == EINTR);
+        if (got < 0) throw system_error("read");
+        if (got == 0) eof_ = true;
+
+        pos_ = buf_.get();
+        end_ = pos_ + tail + std::size_t(got);
+    }
+
+    int fd_;
+    std::unique_ptr<char[]> buf_;  // без обнуления: 16 MiB заполняются read()
+    std::size_t capacity_;
+    bool eof_ = false;
+};
+
+bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+void skip_spaces(ByteSource& src) {
+    while (src.ensure(1) && is_space(*src.data())) src.advance(1);
+}
+
+std::uint64_t read_number(ByteSource& src, const char* what) {
+    skip_spaces(src);
+    std::uint64_t value = 0;
+    std::size_t digits = 0;
+    while (src.ensure(1) && *src.data() >= '0' && *src.data() <= '9') {
+        value = value * 10 + std::uint64_t(*src.data() - '0');
+        if (value > 0xFFFFFFFFull) throw std::runtime_error(std::string("bad header: ") + what + " is too large");
+        src.advance(1);
+        digits++;
+    }
+    if (digits == 0) throw std::runtime_error(std::string("bad header: expected ") + what);
+    return value;
+}
+
+// 64 символа -> 64 бита: бит k равен 1, если p[k] == '1'.
+// В bad накапливаются позиции символов, отличных от '0' и '1'.
+inline std::uint64_t pack64(const char* p, std::uint64_t& bad) {
+#if defined(__AVX2__)
+    const __m256i one = _mm256_set1_epi8('1');
+    const __m256i zero = _mm256_set1_epi8('0');
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    std::uint64_t ones =
+        std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, one)))) |
+        std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, one)))) << 32;
+    std::uint64_t zeros =
+        std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, zero)))) |
+        std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, zero)))) << 32;
+#elif defined(__SSE2__)
+    const __m128i one = _mm_set1_epi8('1');
+    const __m128i zero = _mm_set1_epi8('0');
+    std::uint64_t ones = 0, zeros = 0;
+    for (int k = 0; k < 4; k++) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+        ones |= std::uint64_t(std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, one)))) << (16 * k);
+        zeros |= std::uint64_t(std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)))) << (16 * k);
+    }
+#else
+    std::uint64_t ones = 0, zeros = 0;
+    for (int k = 0; k < 64; k++) {
+        ones |= std::uint64_t(p[k] == '1') << k;
+        zeros |= std::uint64_t(p[k] == '0') << k;
+    }
+#endif
+    bad |= ~(ones | zeros);
+    return ones;
+}
+
+// Упаковывает строку из cols символов; false, если в ней есть посторонние символы.
+bool pack_row(const char* p, std::size_t cols, std::uint64_t* out) {
+    std::uint64_t bad = 0;
+    std::size_t full = cols / 64;
+    for (std::size_t w = 0; w < full; w++) out[w] = pack64(p + w * 64, bad);
+
+    std::size_t rest = cols % 64;
+    if (rest != 0) {
+        const char* tail = p + full * 64;
+        std::uint64_t word = 0;
+        for (std::size_t k = 0; k < rest; k++) {
+            if (tail[k] == '1') word |= std::uint64_t(1) << k;
+            else if (tail[k] != '0') bad = 1;
+        }
+        out[full] = word;
+    }
+    return bad == 0;
+}
+
+// Построчный разбор; Target решает, куда класть упакованную строку:
+//   std::uint64_t* row_buffer(i) — куда упаковать строку i;
+//   bool row_done(i)             — false, чтобы прекратить чтение.
+// После rows строк во входе допустимы только пробельные символы.
+template<class Target>
+void scan_rows(ByteSource& src, std::size_t rows, std::size_t cols, Target& target) {
+    for (std::size_t i = 0; i < rows; i++) {
+        skip_spaces(src);
+        if (!src.ensure(cols))
+            throw std::runtime_error("unexpected end of input at row " + std::to_string(i + 1));
+        if (!pack_row(src.data(), cols, target.row_buffer(i)))
+            throw std::runtime_error("row " + std::to_string(i + 1) + ": expected " +
+                                     std::to_string(cols) + " characters '0'/'1'");
+        src.advance(cols);
+        if (src.ensure(1) && !is_space(*src.data()))
+            throw std::runtime_error("row " + std::to_string(i + 1) + ": longer than " +
+                                     std::to_string(cols) + " characters");
+        if (!target.row_done(i)) return;
+    }
+    skip_spaces(src);
+    if (src.ensure(1)) throw std::runtime_error("more than " + std::to_string(rows) + " rows");
+}
+
+struct BitsetTarget {
+    BinaryMatrix& matrix;
+
+    std::uint64_t* row_buffer(std::size_t i) { return matrix.row(i); }
+    bool row_done(std::size_t) { return true; }
+};
+
+struct ListsTarget {
+    ColumnLists& lists;
+    std::vector<std::uint64_t> row;
+    double row_pairs = 0;
+    double pair_limit = 0;
+    bool stopped = false;
+
+    std::uint64_t* row_buffer(std::size_t) { return row.data(); }
+
+    bool row_done(std::size_t) {
+        std::size_t before = lists.columns.size();
+        for (std::size_t w = 0; w < row.size(); w++) {
+            for (std::uint64_t bits = row[w]; bits != 0; bits &= bits - 1)
+                lists.columns.push_back(static_cast<std::uint32_t>(w * 64 + ctz64(bits)));
+        }
+        lists.offsets.push_back(lists.columns.size());
+
+        double d = double(lists.columns.size() - before);
+        row_pairs += d * (d - 1) / 2;
+        stopped = row_pairs > pair_limit;
+        return !stopped;
+    }
+};
+
+LoadedMatrix load_from(ByteSource& src, MatrixLayout layout, std::size_t bitset_limit) {
+    LoadedMatrix result;
+    std::uint64_t n = read_number(src, "N");
+    std::uint64_t m = read_number(src, "M");
+    if (n < 1 || m < 1) throw std::runtime_error("bad header: N and M must be >= 1");
+    result.rows = static_cast<std::size_t>(n);
+    result.cols = static_cast<std::size_t>(m);
+
+    std::size_t words = (result.cols + 63) / 64;
+    std::size_t bitset_bytes = result.rows * words * sizeof(std::uint64_t);
+    if (layout == MatrixLayout::Auto)
+        layout = bitset_bytes <= bitset_limit ? MatrixLayout::Bitset : MatrixLayout::Lists;
+    result.layout = layout;
+
+    if (layout == MatrixLayout::Bitset) {
+        result.bits = BinaryMatrix(result.rows, result.cols);
+        BitsetTarget target{result.bits};
+        scan_rows(src, result.rows, result.cols, target);
+    } else {
+        result.lists.offsets.reserve(result.rows + 1);
+        result.lists.offsets.push_back(0);
+        ListsTarget target{result.lists, std::vector<std::uint64_t>(words, 0)};
+        target.pair_limit = double(result.cols) * double(result.cols - 1) / 2;
+        scan_rows(src, result.rows, result.cols, target);
+        result.stopped_by_bound = target.stopped;
+    }
+    return result;
+}
+
+} // namespace
+
+LoadedMatrix load_matrix(const std::string& path, MatrixLayout layout, std::size_t bitset_limit) {
+    if (path.empty() || path == "-") {
+        StreamSource src(STDIN_FILENO);
+        return load_from(src, layout, bitset_limit);
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw system_error("cannot open " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw system_error("cannot stat " + path);
+    }
+
+    try {
+        LoadedMatrix result;
+        if (S_ISREG(st.st_mode)) {
+            MappedFile src(fd, static_cast<std::size_t>(st.st_size));
+            result = load_from(src, layout, bitset_limit);
+        } else {
+            StreamSource src(fd);
+            result = load_from(src, layout, bitset_limit);
+        }
+        ::close(fd);
+        return result;
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+#include "binary_matrix.hpp"
+
+// В каком виде держать матрицу в памяти после чтения.
+//   Bitset — упакованные строки, N * ceil(M / 64) * 8 байт;
+//   Lists  — списки столбцов (CSR), 4 байта на единицу;
+//   Auto   — Bitset, если он помещается в лимит, иначе Lists.
+enum class MatrixLayout { Auto, Bitset, Lists };
+
+const char* layout_name(MatrixLayout layout);
+bool parse_layout(const std::string& name, MatrixLayout& layout);
+
+struct LoadedMatrix {
+    MatrixLayout layout = MatrixLayout::Bitset;
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    BinaryMatrix bits;    // layout == Bitset
+    ColumnLists lists;    // layout == Lists
+    // Чтение в Lists остановлено досрочно: sum C(deg(row), 2) уже превысила
+    // C(M, 2), то есть цикл заведомо есть, а остаток файла не проверялся.
+    // lists тогда содержит только прочитанные строки (цикл есть и среди них).
+    bool stopped_by_bound = false;
+};
+
+// Читает матрицу в формате задачи: "N M", затем N строк из M символов '0'/'1'.
+// Файл отображается в память через mmap, stdin (path пустой или "-")
+// читается блоками по 16 MiB. Символы упаковываются по 64 штуки в слово
+// сравнением векторов и movemask (AVX2 / SSE2), прямо в итоговую структуру.
+// При нарушении формата бросает std::runtime_error.
+LoadedMatrix load_matrix(const std::string& path,
+                         MatrixLayout layout = MatrixLayout::Bitset,
+                         std::size_t bitset_limit = ~std::size_t(0));
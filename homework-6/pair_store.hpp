@@ -0,0 +1,228 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Множество пар столбцов (c1 < c2) на хеш-таблице с открытой адресацией.
+// Ключи хранятся прямо в слотах, без узлов и аллокаций на вставку.
+class PairHashSet {
+public:
+    explicit PairHashSet(std::size_t cols, std::size_t expected)
+        : cols_(cols), slots_(capacity_for(expected), kEmpty) {
+        mask_ = slots_.size() - 1;
+        shift_ = 64;
+        for (std::size_t c = slots_.size(); c > 1; c >>= 1) shift_--;
+    }
+
+    // Ёмкость — степень двойки с заполнением не больше половины.
+    static std::size_t capacity_for(std::size_t expected) {
+        std::size_t cap = 16;
+        while (cap < expected * 2) cap <<= 1;
+        return cap;
+    }
+
+    static std::size_t bytes_for(std::size_t expected) {
+        return capacity_for(expected) * sizeof(std::uint64_t);
+    }
+
+    // false, если пара уже встречалась
+    bool insert(std::uint32_t c1, std::uint32_t c2) {
+        std::uint64_t key = std::uint64_t(c1) * cols_ + c2;
+        std::size_t i = static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+        for (;;) {
+            std::uint64_t& slot = slots_[i];
+            if (slot == kEmpty) {
+                slot = key;
+                return true;
+            }
+            if (slot == key) return false;
+            i = (i + 1) & mask_;
+        }
+    }
+
+private:
+    static constexpr std::uint64_t kEmpty = ~std::uint64_t(0);
+
+    std::uint64_t cols_;
+    std::vector<std::uint64_t> slots_;
+    std::size_t mask_ = 0;
+    unsigned shift_ = 64;
+};
+
+// Битовая отметка для каждой из C(M, 2) пар столбцов (треугольная нумерация).
+class PairMarks {
+public:
+    explicit PairMarks(std::size_t cols)
+        : cols_(cols), bits_(words_for(cols), 0) {}
+
+    static std::size_t words_for(std::size_t cols) {
+        std::uint64_t pairs = std::uint64_t(cols) * (cols - (cols ? 1 : 0)) / 2;
+        return static_cast<std::size_t>((pairs + 63) / 64);
+    }
+
+    static std::size_t bytes_for(std::size_t cols) {
+        return words_for(cols) * sizeof(std::uint64_t);
+    }
+
+    static std::uint64_t index(std::uint64_t cols, std::uint64_t c1, std::uint64_t c2) {
+        return c1 * (2 * cols - c1 - 1) / 2 + (c2 - c1 - 1);
+    }
+
+    bool insert(std::uint32_t c1, std::uint32_t c2) {
+        std::uint64_t idx = index(cols_, c1, c2);
+        std::uint64_t& word = bits_[idx / 64];
+        std::uint64_t bit = std::uint64_t(1) << (idx % 64);
+        if (word & bit) return false;
+        word |= bit;
+        return true;
+    }
+
+private:
+    std::uint64_t cols_;
+    std::vector<std::uint64_t> bits_;
+};
+
+// Те же структуры для параллельного режима: вставка из нескольких потоков
+// без блокировок. Состав и размер памяти совпадают с однопоточными.
+
+class ConcurrentPairHashSet {
+public:
+    explicit ConcurrentPairHashSet(std::size_t cols, std::size_t expected)
+        : cols_(cols), slots_(PairHashSet::capacity_for(expected)) {
+        for (auto& slot : slots_) slot.store(kEmpty, std::memory_order_relaxed);
+        mask_ = slots_.size() - 1;
+        shift_ = 64;
+        for (std::size_t c = slots_.size(); c > 1; c >>= 1) shift_--;
+    }
+
+    // false, если пара уже встречалась (в том числе в другом потоке).
+    // Различных пар не больше C(M, 2), так что таблица не переполняется.
+    bool insert(std::uint32_t c1, std::uint32_t c2) {
+        std::uint64_t key = std::uint64_t(c1) * cols_ + c2;
+        std::size_t i = static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+        for (;;) {
+            std::uint64_t cur = slots_[i].load(std::memory_order_relaxed);
+            // При неудаче compare_exchange кладёт в cur ключ, занявший слот
+            if (cur == kEmpty && slots_[i].compare_exchange_strong(cur, key, std::memory_order_relaxed))
+                return true;
+            if (cur == key) return false;
+            i = (i + 1) & mask_;
+        }
+    }
+
+private:
+    static constexpr std::uint64_t kEmpty = ~std::uint64_t(0);
+
+    std::uint64_t cols_;
+    std::vector<std::atomic<std::uint64_t>> slots_;
+    std::size_t mask_ = 0;
+    unsigned shift_ = 64;
+};
+
+class ConcurrentPairMarks {
+public:
+    explicit ConcurrentPairMarks(std::size_t cols)
+        : cols_(cols), bits_(PairMarks::words_for(cols)) {}  // атомики обнуляются
+
+    bool insert(std::uint32_t c1, std::uint32_t c2) {
+        std::uint64_t idx = PairMarks::index(cols_, c1, c2);
+        std::uint64_t bit = std::uint64_t(1) << (idx % 64);
+        return (bits_[idx / 64].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+    }
+
+private:
+    std::uint64_t cols_;
+    std::vector<std::atomic<std::uint64_t>> bits_;
+};
+
+// Счётчики вхождений пар столбцов для инкрементального режима. Открытая
+// адресация с линейным пробированием; пара со счётчиком 0 удаляется сдвигом
+// следующих элементов назад, без «надгробий». Таблица удваивается, когда
+// заполнена больше чем наполовину.
+class PairCountMap {
+public:
+    explicit PairCountMap(std::size_t cols, std::size_t expected = 0)
+        : cols_(cols) {
+        resize(PairHashSet::capacity_for(expected));
+    }
+
+    std::size_t size() const { return size_; }
+
+    std::uint32_t count(std::uint32_t c1, std::uint32_t c2) const {
+        std::uint64_t key = key_of(c1, c2);
+        for (std::size_t i = home(key);; i = (i + 1) & mask_) {
+            if (slots_[i].key == key) return slots_[i].count;
+            if (slots_[i].key == kEmpty) return 0;
+        }
+    }
+
+    // Возвращают новое значение счётчика
+    std::uint32_t add(std::uint32_t c1, std::uint32_t c2) {
+        if ((size_ + 1) * 2 > slots_.size()) resize(slots_.size() * 2);
+        std::uint64_t key = key_of(c1, c2);
+        std::size_t i = home(key);
+        while (slots_[i].key != key && slots_[i].key != kEmpty) i = (i + 1) & mask_;
+        if (slots_[i].key == kEmpty) {
+            slots_[i] = Slot{key, 0};
+            size_++;
+        }
+        return ++slots_[i].count;
+    }
+
+    // Пара должна присутствовать
+    std::uint32_t remove(std::uint32_t c1, std::uint32_t c2) {
+        std::uint64_t key = key_of(c1, c2);
+        std::size_t i = home(key);
+        while (slots_[i].key != key) i = (i + 1) & mask_;
+        if (--slots_[i].count != 0) return slots_[i].count;
+
+        // Сдвигаем назад элементы цепочки, которые могут занять освободившийся слот
+        for (std::size_t j = (i + 1) & mask_; slots_[j].key != kEmpty; j = (j + 1) & mask_) {
+            if (((j - home(slots_[j].key)) & mask_) >= ((j - i) & mask_)) {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i].key = kEmpty;
+        size_--;
+        return 0;
+    }
+
+private:
+    static constexpr std::uint64_t kEmpty = ~std::uint64_t(0);
+
+    struct Slot {
+        std::uint64_t key;
+        std::uint32_t count;
+    };
+
+    std::uint64_t key_of(std::uint32_t c1, std::uint32_t c2) const {
+        return std::uint64_t(c1) * cols_ + c2;
+    }
+
+    std::size_t home(std::uint64_t key) const {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    void resize(std::size_t capacity) {
+        std::vector<Slot> old(capacity, Slot{kEmpty, 0});
+        old.swap(slots_);
+        mask_ = slots_.size() - 1;
+        shift_ = 64;
+        for (std::size_t c = slots_.size(); c > 1; c >>= 1) shift_--;
+
+        for (const Slot& s : old) {
+            if (s.key == kEmpty) continue;
+            std::size_t i = home(s.key);
+            while (slots_[i].key != kEmpty) i = (i + 1) & mask_;
+            slots_[i] = s;
+        }
+    }
+
+    std::uint64_t cols_;
+    std::vector<Slot> slots_;
+    std::size_t size_ = 0;
+    std::size_t mask_ = 0;
+    unsigned shift_ = 64;
+};
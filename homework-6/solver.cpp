@@ -0,0 +1,460 @@
+#include "solver.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pair_store.hpp"
+#include "work_pool.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+const char* mode_name(SolverMode mode) {
+    switch (mode) {
+    case SolverMode::Auto: return "auto";
+    case SolverMode::Bitset: return "bitset";
+    case SolverMode::Pairs: return "pairs";
+    }
+    return "?";
+}
+
+bool parse_mode(const std::string& name, SolverMode& mode) {
+    if (name == "auto") mode = SolverMode::Auto;
+    else if (name == "bitset") mode = SolverMode::Bitset;
+    else if (name == "pairs") mode = SolverMode::Pairs;
+    else return false;
+    return true;
+}
+
+const char* store_name(PairStore store) {
+    switch (store) {
+    case PairStore::Auto: return "auto";
+    case PairStore::Marks: return "marks";
+    case PairStore::Hash: return "hash";
+    case PairStore::None: return "none";
+    }
+    return "?";
+}
+
+bool parse_store(const std::string& name, PairStore& store) {
+    if (name == "auto") store = PairStore::Auto;
+    else if (name == "marks") store = PairStore::Marks;
+    else if (name == "hash") store = PairStore::Hash;
+    else return false;
+    return true;
+}
+
+static double choose2(double n) {
+    return n * (n - 1) / 2;
+}
+
+MatrixProfile profile_matrix(const BinaryMatrix& m) {
+    MatrixProfile p;
+    std::vector<std::uint32_t> col_degree(m.cols(), 0);
+
+    for (std::size_t i = 0; i < m.rows(); i++) {
+        const std::uint64_t* r = m.row(i);
+        std::size_t d = 0;
+        for (std::size_t w = 0; w < m.words_per_row(); w++) {
+            for (std::uint64_t bits = r[w]; bits != 0; bits &= bits - 1) {
+                col_degree[w * 64 + ctz64(bits)]++;
+                d++;
+            }
+        }
+        p.ones += d;
+        p.row_pairs += choose2(double(d));
+        if (d >= 2) p.active_rows++;
+    }
+    for (std::uint32_t c : col_degree) p.col_pairs += choose2(double(c));
+    return p;
+}
+
+MatrixProfile profile_lists(const ColumnLists& lists, std::size_t cols) {
+    MatrixProfile p;
+    std::vector<std::uint32_t> col_degree(cols, 0);
+
+    for (std::size_t i = 0; i < lists.rows(); i++) {
+        std::size_t d = lists.degree(i);
+        for (const std::uint32_t* c = lists.begin(i); c != lists.end(i); ++c) col_degree[*c]++;
+        p.ones += d;
+        p.row_pairs += choose2(double(d));
+        if (d >= 2) p.active_rows++;
+    }
+    for (std::uint32_t c : col_degree) p.col_pairs += choose2(double(c));
+    return p;
+}
+
+bool exceeds_pair_bound(std::size_t rows, std::size_t cols, const MatrixProfile& p) {
+    return p.row_pairs > choose2(double(cols)) || p.col_pairs > choose2(double(rows));
+}
+
+SolverMode choose_mode(const BinaryMatrix& m, const MatrixProfile& p) {
+    // Грубая стоимость в «операциях над словом»: пересечение пары строк —
+    // words_per_row слов, вставка пары столбцов в хеш — порядка 16 таких операций.
+    double bitset_cost = choose2(double(p.active_rows)) * double(m.words_per_row());
+    double pairs_cost = p.row_pairs * 16.0;
+    return bitset_cost <= pairs_cost ? SolverMode::Bitset : SolverMode::Pairs;
+}
+
+// Число общих единиц двух строк, но не больше 2: дальше считать незачем.
+static unsigned common_ones_capped(const std::uint64_t* a, const std::uint64_t* b, std::size_t words) {
+    unsigned count = 0;
+    std::size_t w = 0;
+#if defined(__AVX2__)
+    for (; w + 4 <= words; w += 4) {
+        __m256i x = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + w)),
+                                     _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + w)));
+        if (_mm256_testz_si256(x, x)) continue;
+
+        alignas(32) std::uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), x);
+        count += popcount64(lanes[0]) + popcount64(lanes[1]) + popcount64(lanes[2]) + popcount64(lanes[3]);
+        if (count >= 2) return 2;
+    }
+#endif
+    for (; w < words; w++) {
+        count += popcount64(a[w] & b[w]);
+        if (count >= 2) return 2;
+    }
+    return count;
+}
+
+// Запуск потоков стоит десятков микросекунд — на меньших матрицах
+// однопоточный поиск быстрее.
+static std::size_t effective_threads(std::size_t threads, std::size_t rows) {
+    return rows < 1024 ? 1 : resolve_threads(threads);
+}
+
+// Блоков заметно больше, чем потоков, чтобы было что красть.
+static std::size_t block_size(std::size_t items, std::size_t threads) {
+    return std::max<std::size_t>(1, items / (threads * 64));
+}
+
+// Первые два общих столбца строк, у которых их заведомо не меньше двух.
+static void common_columns(const std::uint64_t* a, const std::uint64_t* b, std::size_t words,
+                           CycleWitness& witness) {
+    std::size_t found = 0;
+    for (std::size_t w = 0; w < words && found < 2; w++) {
+        for (std::uint64_t bits = a[w] & b[w]; bits != 0 && found < 2; bits &= bits - 1) {
+            std::size_t c = w * 64 + ctz64(bits);
+            if (found++ == 0) witness.c1 = c;
+            else witness.c2 = c;
+        }
+    }
+}
+
+bool has_cycle_bitset(const BinaryMatrix& m, std::size_t threads, CycleWitness* witness) {
+    // Строки с одной единицей или без единиц в цикле участвовать не могут
+    std::vector<std::size_t> active;
+    for (std::size_t i = 0; i < m.rows(); i++) {
+        if (m.row_degree(i) >= 2) active.push_back(i);
+    }
+
+    const std::size_t words = m.words_per_row();
+    auto report = [&](std::size_t a, std::size_t b) {
+        if (!witness) return;
+        witness->v1 = active[a];
+        witness->v2 = active[b];
+        common_columns(m.row(active[a]), m.row(active[b]), words, *witness);
+    };
+
+    threads = effective_threads(threads, active.size());
+    if (threads == 1) {
+        for (std::size_t a = 0; a < active.size(); a++) {
+            for (std::size_t b = a + 1; b < active.size(); b++) {
+                if (common_ones_capped(m.row(active[a]), m.row(active[b]), words) >= 2) {
+                    report(a, b);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Блок — отрезок первых строк пары; ранние блоки дороже поздних
+    // (треугольный обход), это выравнивает кража работы.
+    //
+    // Без свидетеля любой найденный цикл останавливает всех. Со свидетелем
+    // нужен тот же цикл, что и в однопоточном обходе, — лексикографически
+    // первая пара (a, b). Она хранится упакованной в best как a << 32 | b
+    // и обновляется атомарным минимумом; поток бросает строку a, как только
+    // в best оказалась пара с меньшим a.
+    constexpr std::uint64_t kNone = ~std::uint64_t(0);
+    std::atomic<bool> found{false};
+    std::atomic<std::uint64_t> best{kNone};
+    auto cancelled = [&](std::size_t a) {
+        if (witness) return (best.load(std::memory_order_relaxed) >> 32) < a;
+        return found.load(std::memory_order_relaxed);
+    };
+
+    const std::size_t rows_per_block = block_size(active.size(), threads);
+    const std::size_t blocks = (active.size() + rows_per_block - 1) / rows_per_block;
+    run_blocks(threads, blocks, found, [&](std::size_t block) {
+        std::size_t first = block * rows_per_block;
+        std::size_t last = std::min(first + rows_per_block, active.size());
+        for (std::size_t a = first; a < last; a++) {
+            const std::uint64_t* row_a = m.row(active[a]);
+            for (std::size_t b = a + 1; b < active.size(); b++) {
+                if (cancelled(a)) return;
+                if (common_ones_capped(row_a, m.row(active[b]), words) < 2) continue;
+
+                if (!witness) {
+                    found.store(true, std::memory_order_relaxed);
+                    return;
+                }
+                std::uint64_t key = std::uint64_t(a) << 32 | b;
+                std::uint64_t cur = best.load(std::memory_order_relaxed);
+                while (key < cur && !best.compare_exchange_weak(cur, key, std::memory_order_relaxed)) {}
+                // Дальнейшие строки блока дают пары с большим a
+                return;
+            }
+        }
+    });
+
+    if (!witness) return found.load();
+    std::uint64_t key = best.load();
+    if (key == kNone) return false;
+    report(std::size_t(key >> 32), std::size_t(key & 0xFFFFFFFFu));
+    return true;
+}
+
+std::size_t pair_store_bytes(PairStore store, std::size_t cols, double row_pairs) {
+    switch (store) {
+    case PairStore::Marks:
+        return PairMarks::bytes_for(cols);
+    case PairStore::Hash: {
+        double expected = std::min(row_pairs, choose2(double(cols)) + 1);
+        return PairHashSet::bytes_for(static_cast<std::size_t>(expected));
+    }
+    default:
+        return 0;
+    }
+}
+
+PairStore choose_pair_store(std::size_t cols, double row_pairs, std::size_t mem_limit) {
+    // Из помещающихся в лимит берём меньшее: оно лучше ложится в кеш
+    std::size_t marks = pair_store_bytes(PairStore::Marks, cols, row_pairs);
+    std::size_t hash = pair_store_bytes(PairStore::Hash, cols, row_pairs);
+    bool marks_fit = marks <= mem_limit;
+    bool hash_fit = hash <= mem_limit;
+    if (marks_fit && (!hash_fit || marks <= hash)) return PairStore::Marks;
+    if (hash_fit) return PairStore::Hash;
+    return PairStore::None;
+}
+
+// Повтор пары: пара (c1, c2) строки row уже встречалась в другой строке.
+struct PairHit {
+    std::size_t row = 0;
+    std::uint32_t c1 = 0;
+    std::uint32_t c2 = 0;
+};
+
+static bool row_has(const ColumnLists& lists, std::size_t i, std::uint32_t c) {
+    return std::binary_search(lists.begin(i), lists.end(i), c);
+}
+
+// Любая строка, кроме skip, где есть оба столбца.
+static std::size_t other_row_with(const ColumnLists& lists, std::uint32_t c1, std::uint32_t c2,
+                                  std::size_t skip) {
+    for (std::size_t i = 0; i < lists.rows(); i++) {
+        if (i != skip && row_has(lists, i, c1) && row_has(lists, i, c2)) return i;
+    }
+    return lists.rows();
+}
+
+// Останавливается на первой повторной паре; по принципу Дирихле это случится
+// не позже чем через C(M, 2) + 1 вставок, каким бы ни был вход.
+// Просматриваются строки [0, rows).
+template<class Store>
+static bool find_repeated_pair(const ColumnLists& lists, std::size_t rows, Store& seen, PairHit& hit) {
+    for (std::size_t i = 0; i < rows; i++) {
+        const std::uint32_t* first = lists.begin(i);
+        const std::uint32_t* last = lists.end(i);
+        for (const std::uint32_t* c1 = first; c1 != last; ++c1) {
+            for (const std::uint32_t* c2 = c1 + 1; c2 != last; ++c2) {
+                if (!seen.insert(*c1, *c2)) {
+                    hit = PairHit{i, *c1, *c2};
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+template<class Store>
+static bool find_repeated_pair_parallel(const ColumnLists& lists, Store& seen, std::size_t threads,
+                                        PairHit& hit) {
+    std::atomic<bool> found{false};
+    const std::size_t rows_per_block = block_size(lists.rows(), threads);
+    const std::size_t blocks = (lists.rows() + rows_per_block - 1) / rows_per_block;
+    run_blocks(threads, blocks, found, [&](std::size_t block) {
+        std::size_t first = block * rows_per_block;
+        std::size_t last = std::min(first + rows_per_block, lists.rows());
+        for (std::size_t i = first; i < last; i++) {
+            const std::uint32_t* row_end = lists.end(i);
+            for (const std::uint32_t* c1 = lists.begin(i); c1 != row_end; ++c1) {
+                if (found.load(std::memory_order_relaxed)) return;
+                for (const std::uint32_t* c2 = c1 + 1; c2 != row_end; ++c2) {
+                    if (seen.insert(*c1, *c2)) continue;
+                    // hit пишет только первый нашедший; читается после join
+                    if (!found.exchange(true, std::memory_order_relaxed)) hit = PairHit{i, *c1, *c2};
+                    return;
+                }
+            }
+        }
+    });
+    return found.load();
+}
+
+// Однопоточный поиск по строкам [0, rows). Свидетель: v2 — первая строка,
+// замыкающая цикл, (c1, c2) — её первая повторная пара, v1 — единственная
+// более ранняя строка с этой парой (до v2 повторов не было).
+template<class Store>
+static bool search_rows(const ColumnLists& lists, std::size_t rows, Store& seen, CycleWitness* witness) {
+    PairHit hit;
+    if (!find_repeated_pair(lists, rows, seen, hit)) return false;
+    if (witness) {
+        witness->v1 = other_row_with(lists, hit.c1, hit.c2, hit.row);
+        witness->v2 = hit.row;
+        witness->c1 = hit.c1;
+        witness->c2 = hit.c2;
+    }
+    return true;
+}
+
+bool has_cycle_pairs(const ColumnLists& lists, std::size_t cols, PairStore store, std::size_t threads,
+                     CycleWitness* witness) {
+    threads = effective_threads(threads, lists.rows());
+    double pairs = 0;
+    if (store == PairStore::Hash) {
+        for (std::size_t i = 0; i < lists.rows(); i++) pairs += choose2(double(lists.degree(i)));
+    }
+    std::size_t expected = static_cast<std::size_t>(std::min(pairs, choose2(double(cols)) + 1));
+
+    // Параллельный проход находит какой-то повтор (строки i и j) в порядке,
+    // зависящем от расписания потоков. Чтобы свидетель не зависел от числа
+    // потоков, его затем ищет однопоточный проход, но только по строкам
+    // [0, max(i, j)] — цикл среди них уже есть.
+    std::size_t rows = lists.rows();
+    if (threads > 1) {
+        PairHit hit;
+        bool found;
+        if (store == PairStore::Marks) {
+            ConcurrentPairMarks seen(cols);
+            found = find_repeated_pair_parallel(lists, seen, threads, hit);
+        } else {
+            ConcurrentPairHashSet seen(cols, expected);
+            found = find_repeated_pair_parallel(lists, seen, threads, hit);
+        }
+        if (!found || !witness) return found;
+        rows = std::max(hit.row, other_row_with(lists, hit.c1, hit.c2, hit.row)) + 1;
+    }
+
+    if (store == PairStore::Marks) {
+        PairMarks seen(cols);
+        return search_rows(lists, rows, seen, witness);
+    }
+    PairHashSet seen(cols, expected);
+    return search_rows(lists, rows, seen, witness);
+}
+
+SolveResult solve(const BinaryMatrix& m, const SolverOptions& options) {
+    SolveResult result;
+    result.threads = resolve_threads(options.threads);
+    CycleWitness* witness = options.witness ? &result.witness : nullptr;
+    MatrixProfile profile = profile_matrix(m);
+
+    SolverMode mode = options.mode;
+    // Граница доказывает существование цикла, но не указывает его
+    if (!options.witness && exceeds_pair_bound(m.rows(), m.cols(), profile)) {
+        result.has_cycle = true;
+        result.mode = mode;
+        result.by_bound = true;
+        return result;
+    }
+
+    if (mode == SolverMode::Auto) mode = choose_mode(m, profile);
+
+    if (mode == SolverMode::Pairs) {
+        PairStore store = options.store;
+        if (store == PairStore::Auto)
+            store = choose_pair_store(m.cols(), profile.row_pairs, options.mem_limit);
+        else if (pair_store_bytes(store, m.cols(), profile.row_pairs) > options.mem_limit)
+            store = PairStore::None;
+
+        if (store != PairStore::None) {
+            result.mode = SolverMode::Pairs;
+            result.store = store;
+            result.has_cycle = has_cycle_pairs(ColumnLists::from_matrix(m), m.cols(), store, result.threads, witness);
+            result.has_witness = options.witness && result.has_cycle;
+            return result;
+        }
+        // Хранилище пар не помещается в лимит — битсеты уже в памяти
+        result.fell_back = true;
+    }
+
+    result.mode = SolverMode::Bitset;
+    result.has_cycle = has_cycle_bitset(m, result.threads, witness);
+    result.has_witness = options.witness && result.has_cycle;
+    return result;
+}
+
+static std::string mib(std::size_t bytes) {
+    return std::to_string((bytes + (std::size_t(1) << 20) - 1) >> 20) + " MiB";
+}
+
+SolveResult solve(const ColumnLists& lists, std::size_t cols, const SolverOptions& options) {
+    SolveResult result;
+    result.threads = resolve_threads(options.threads);
+    CycleWitness* witness = options.witness ? &result.witness : nullptr;
+    MatrixProfile profile = profile_lists(lists, cols);
+
+    SolverMode mode = options.mode;
+    if (!options.witness && exceeds_pair_bound(lists.rows(), cols, profile)) {
+        result.has_cycle = true;
+        result.mode = mode;
+        result.by_bound = true;
+        return result;
+    }
+
+    if (mode != SolverMode::Bitset) {
+        PairStore store = options.store;
+        if (store == PairStore::Auto)
+            store = choose_pair_store(cols, profile.row_pairs, options.mem_limit);
+        else if (pair_store_bytes(store, cols, profile.row_pairs) > options.mem_limit)
+            store = PairStore::None;
+
+        if (store != PairStore::None) {
+            result.mode = SolverMode::Pairs;
+            result.store = store;
+            result.has_cycle = has_cycle_pairs(lists, cols, store, result.threads, witness);
+            result.has_witness = options.witness && result.has_cycle;
+            return result;
+        }
+        result.fell_back = true;
+    }
+
+    // Загрузчик выбирает списки как раз тогда, когда битсеты не влезают в
+    // лимит, так что молча строить их здесь нельзя
+    std::size_t bitset_bytes = lists.rows() * ((cols + 63) / 64) * sizeof(std::uint64_t);
+    if (bitset_bytes > options.mem_limit) {
+        std::string what = "bitsets need " + mib(bitset_bytes);
+        if (result.fell_back) {
+            std::size_t pairs = std::min(pair_store_bytes(PairStore::Marks, cols, profile.row_pairs),
+                                         pair_store_bytes(PairStore::Hash, cols, profile.row_pairs));
+            what = "pair storage needs " + mib(pairs) + " and " + what;
+        }
+        throw std::runtime_error(what + ", over --mem-limit " + mib(options.mem_limit));
+    }
+
+    result.mode = SolverMode::Bitset;
+    result.has_cycle = has_cycle_bitset(lists.to_matrix(cols), result.threads, witness);
+    result.has_witness = options.witness && result.has_cycle;
+    return result;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+#include "binary_matrix.hpp"
+
+// Способ поиска цикла длины 4.
+//   Bitset — попарное пересечение строк-битсетов через popcount,
+//            выгодно на плотных матрицах с небольшим числом строк;
+//   Pairs  — перечисление пар столбцов каждой строки с остановкой на первом
+//            повторе, выгодно на разреженных матрицах.
+//   Auto   — выбор по оценке стоимости (choose_mode).
+enum class SolverMode { Auto, Bitset, Pairs };
+
+// Где режим Pairs запоминает уже встреченные пары столбцов.
+//   Marks — битовый массив на все C(M, 2) пар, по одному биту на пару;
+//   Hash  — компактная хеш-таблица с открытой адресацией на встреченные пары;
+//   None  — ни то, ни другое не помещается в лимит памяти.
+enum class PairStore { Auto, Marks, Hash, None };
+
+const char* mode_name(SolverMode mode);
+bool parse_mode(const std::string& name, SolverMode& mode);
+
+const char* store_name(PairStore store);
+bool parse_store(const std::string& name, PairStore& store);
+
+// Цикл v1 -> c1 -> v2 -> c2 -> v1, индексы с нуля; v1 < v2, c1 < c2.
+struct CycleWitness {
+    std::size_t v1 = 0;
+    std::size_t v2 = 0;
+    std::size_t c1 = 0;
+    std::size_t c2 = 0;
+};
+
+struct SolverOptions {
+    SolverMode mode = SolverMode::Auto;
+    PairStore store = PairStore::Auto;
+    std::size_t mem_limit = std::size_t(1) << 30;  // байт на вспомогательные структуры
+    std::size_t threads = 1;                       // 0 — по числу аппаратных потоков
+    bool witness = false;                          // найти сам цикл, а не только ответ
+};
+
+// Сводка по матрице, на которой основан выбор режима.
+struct MatrixProfile {
+    std::size_t ones = 0;
+    std::size_t active_rows = 0;  // строки, где хотя бы две единицы
+    double row_pairs = 0;         // sum C(deg(row), 2)
+    double col_pairs = 0;         // sum C(deg(col), 2)
+};
+
+MatrixProfile profile_matrix(const BinaryMatrix& m);
+MatrixProfile profile_lists(const ColumnLists& lists, std::size_t cols);
+
+// Принцип Дирихле: без цикла каждая пара столбцов встречается не более
+// чем в одной строке, значит sum C(deg(row), 2) <= C(M, 2); симметрично
+// для пар строк. Нарушение любой границы доказывает наличие цикла.
+bool exceeds_pair_bound(std::size_t rows, std::size_t cols, const MatrixProfile& p);
+
+SolverMode choose_mode(const BinaryMatrix& m, const MatrixProfile& p);
+
+// Сколько байт займёт хранилище пар. По тому же принципу Дирихле режим Pairs
+// вставит не больше min(row_pairs, C(M, 2) + 1) пар, так что оценка точная сверху.
+std::size_t pair_store_bytes(PairStore store, std::size_t cols, double row_pairs);
+PairStore choose_pair_store(std::size_t cols, double row_pairs, std::size_t mem_limit);
+
+struct SolveResult {
+    bool has_cycle = false;
+    SolverMode mode = SolverMode::Auto;   // режим, которым получен ответ
+    PairStore store = PairStore::None;    // хранилище пар, если mode == Pairs
+    bool by_bound = false;                // ответ получен по exceeds_pair_bound
+    bool fell_back = false;               // Pairs не влез в mem_limit, использован Bitset
+    std::size_t threads = 1;              // сколько потоков фактически искало
+    bool has_witness = false;             // witness заполнен (запрошен и цикл есть)
+    CycleWitness witness;
+};
+
+SolveResult solve(const BinaryMatrix& m, const SolverOptions& options = SolverOptions());
+
+// То же для матрицы, загруженной сразу в виде списков столбцов. Битсеты
+// строятся из списков, только если выбран Bitset или Pairs не влез в лимит;
+// если и битсеты больше mem_limit — std::runtime_error.
+SolveResult solve(const ColumnLists& lists, std::size_t cols, const SolverOptions& options = SolverOptions());
+
+// При threads != 1 строки (для Bitset — первые строки пар) делятся на блоки,
+// которые разбирает пул с кражей работы (work_pool.hpp). Первый нашедший
+// цикл поток выставляет общий флаг, остальные проверяют его на каждой строке
+// и сразу выходят. Ответ от числа потоков не зависит.
+//
+// Если witness не нулевой, в него записывается найденный цикл — тот же, что
+// и при однопоточном поиске: для Bitset лексикографически первая пара строк
+// (v1, v2) и два первых общих столбца, для Pairs — первая строка v2,
+// замыкающая цикл при обходе сверху вниз.
+bool has_cycle_bitset(const BinaryMatrix& m, std::size_t threads = 1, CycleWitness* witness = nullptr);
+bool has_cycle_pairs(const ColumnLists& lists, std::size_t cols, PairStore store, std::size_t threads = 1,
+                     CycleWitness* witness = nullptr);
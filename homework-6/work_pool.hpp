@@ -0,0 +1,85 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Число рабочих потоков: 0 означает «по числу аппаратных потоков».
+inline std::size_t resolve_threads(std::size_t threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    return std::max<std::size_t>(threads, 1);
+}
+
+// Очередь блоков одного потока — непрерывный отрезок [begin, end).
+// Владелец берёт блоки с начала, вор забирает половину остатка с конца.
+struct alignas(64) BlockQueue {
+    std::mutex lock;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+};
+
+// Выполняет fn(block) для всех block из [0, count) на threads потоках
+// (вызывающий поток — один из них) с кражей работы между очередями.
+// Блоки могут сильно различаться по стоимости: освободившийся поток
+// забирает половину чужого остатка, поэтому потоки заканчивают почти
+// одновременно. Перед каждым блоком проверяется stop; fn может выставить
+// его сам, чтобы остальные потоки прекратили работу.
+template<class Fn>
+void run_blocks(std::size_t threads, std::size_t count, const std::atomic<bool>& stop, Fn&& fn) {
+    threads = std::min(resolve_threads(threads), std::max<std::size_t>(count, 1));
+    if (threads == 1) {
+        for (std::size_t block = 0; block < count && !stop.load(std::memory_order_relaxed); block++)
+            fn(block);
+        return;
+    }
+
+    std::vector<BlockQueue> queues(threads);
+    for (std::size_t t = 0; t < threads; t++) {
+        queues[t].begin = count * t / threads;
+        queues[t].end = count * (t + 1) / threads;
+    }
+
+    auto pop = [&](std::size_t self, std::size_t& block) {
+        std::lock_guard<std::mutex> guard(queues[self].lock);
+        if (queues[self].begin == queues[self].end) return false;
+        block = queues[self].begin++;
+        return true;
+    };
+
+    auto steal = [&](std::size_t self, std::size_t& block) {
+        for (std::size_t k = 1; k < threads; k++) {
+            BlockQueue& victim = queues[(self + k) % threads];
+            std::size_t first, last;
+            {
+                std::lock_guard<std::mutex> guard(victim.lock);
+                std::size_t left = victim.end - victim.begin;
+                if (left == 0) continue;
+                last = victim.end;
+                first = last - (left + 1) / 2;
+                victim.end = first;
+            }
+            // Первый украденный блок выполняем сразу, остальные кладём к себе
+            std::lock_guard<std::mutex> guard(queues[self].lock);
+            queues[self].begin = first + 1;
+            queues[self].end = last;
+            block = first;
+            return true;
+        }
+        return false;
+    };
+
+    // Новых блоков не появляется, поэтому все очереди пусты — работа роздана
+    auto worker = [&](std::size_t self) {
+        std::size_t block;
+        while (!stop.load(std::memory_order_relaxed) && (pop(self, block) || steal(self, block)))
+            fn(block);
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (std::size_t t = 1; t < threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& t : pool) t.join();
+}
@@ -0,0 +1,328 @@
+#include "file_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char* io_mode_name(IoMode mode) {
+    switch (mode) {
+    case IoMode::Mmap: return "mmap";
+    case IoMode::Pread: return "pread";
+    case IoMode::Stream: return "stream";
+    }
+    return "?";
+}
+
+bool parse_io_mode(const std::string& name, IoMode& mode) {
+    if (name == "mmap") mode = IoMode::Mmap;
+    else if (name == "pread") mode = IoMode::Pread;
+    else if (name == "stream") mode = IoMode::Stream;
+    else return false;
+    return true;
+}
+
+namespace {
+
+constexpr std::size_t kBlock = std::size_t(1) << 20;
+
+// pread до n байт или конца файла; -1 при ошибке
+long long pread_full(int fd, char* dst, std::size_t n, std::uint64_t pos) {
+    std::size_t done = 0;
+    while (done < n) {
+        ssize_t got = ::pread(fd, dst + done, n - done, off_t(pos + done));
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) return -1;
+        if (got == 0) break;
+        done += std::size_t(got);
+    }
+    return (long long)done;
+}
+
+// Общая часть для чтения через файловый дескриптор
+class FdReader : public ChunkReader {
+public:
+    ~FdReader() override { close_fd(); }
+
+    bool open(const std::string& path) override {
+        close_fd();
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        return fd_ >= 0;
+    }
+
+    std::size_t read_at(std::uint64_t pos, char* dst, std::size_t n) override {
+        long long got = pread_full(fd_, dst, n, pos);
+        return got < 0 ? 0 : std::size_t(got);
+    }
+
+protected:
+    virtual void close_fd() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    int fd_ = -1;
+};
+
+// Отрезок отображается в память целиком и отдаётся одним блоком.
+// Отображение MAP_PRIVATE с правом записи: страница копируется, только
+// если токенизатор меняет в ней регистр, остальные читаются прямо из
+// page cache.
+class MmapReader : public FdReader {
+public:
+    ~MmapReader() override { unmap(); }
+
+    bool start(std::uint64_t begin, std::uint64_t end) override {
+        unmap();
+        // Файл мог укоротиться: обращение за его концом — SIGBUS
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) return false;
+        end = std::min(end, std::uint64_t(st.st_size));
+        begin = std::min(begin, end);
+
+        std::uint64_t page = std::uint64_t(::sysconf(_SC_PAGESIZE));
+        std::uint64_t offset = begin / page * page;
+        len_ = std::size_t(end - offset);
+        size_ = std::size_t(end - begin);
+        given_ = false;
+        if (size_ == 0) {
+            data_ = nullptr;
+            len_ = 0;
+            return true;
+        }
+        void* p = ::mmap(nullptr, len_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_, off_t(offset));
+        if (p == MAP_FAILED) {
+            len_ = 0;
+            return false;
+        }
+        ::madvise(p, len_, MADV_SEQUENTIAL);
+        map_ = static_cast<char*>(p);
+        data_ = map_ + (begin - offset);
+        return true;
+    }
+
+    bool next(std::size_t, ReadBlock& block) override {
+        block = ReadBlock{data_, given_ ? 0 : size_, true};
+        given_ = true;
+        return true;
+    }
+
+private:
+    void close_fd() override {
+        unmap();
+        FdReader::close_fd();
+    }
+
+    void unmap() {
+        if (map_) ::munmap(map_, len_);
+        map_ = nullptr;
+    }
+
+    char* map_ = nullptr;
+    char* data_ = nullptr;
+    std::size_t len_ = 0;
+    std::size_t size_ = 0;
+    bool given_ = false;
+};
+
+// Два буфера и отдельный поток ввода-вывода: пока рабочий поток разбирает
+// один буфер, в другой читается следующий блок. Перед данными в буфере
+// оставлено место, куда переносится хвост предыдущего блока; слово длиннее
+// этого места собирается в отдельном векторе.
+class PreadReader : public FdReader {
+public:
+    PreadReader() {
+        for (auto& b : buffers_) b.reset(new char[kHeadroom + kBlock]);
+        io_ = std::thread([this] { io_loop(); });
+    }
+
+    ~PreadReader() override {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            stop_ = true;
+        }
+        wake_io_.notify_one();
+        io_.join();
+        close_fd();
+    }
+
+    bool open(const std::string& path) override {
+        wait_idle();
+        if (!FdReader::open(path)) return false;
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+        return true;
+    }
+
+    bool start(std::uint64_t begin, std::uint64_t end) override {
+        wait_idle();
+        pos_ = begin;
+        end_ = end;
+        cur_ = -1;
+        prev_ = nullptr;
+        prev_size_ = 0;
+        issue(0);
+        return true;
+    }
+
+    bool next(std::size_t keep, ReadBlock& block) override {
+        int buf = cur_ < 0 ? 0 : 1 - cur_;
+        std::size_t got;
+        bool more;
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            io_done_.wait(lock, [&] { return !req_.pending; });
+            if (req_.failed) {
+                // errno у каждого потока свой: причину передаёт поток чтения
+                errno = req_.error;
+                return false;
+            }
+            got = req_.got;
+            more = req_.got == req_.size && pos_ < end_;
+        }
+
+        char* data = buffers_[std::size_t(buf)].get() + kHeadroom;
+        if (keep <= kHeadroom) {
+            std::memcpy(data - keep, prev_ + prev_size_ - keep, keep);
+            block = ReadBlock{data - keep, keep + got, !more};
+        } else {
+            std::vector<char> joined(keep + got);
+            std::memcpy(joined.data(), prev_ + prev_size_ - keep, keep);
+            std::memcpy(joined.data() + keep, data, got);
+            spill_.swap(joined);
+            block = ReadBlock{spill_.data(), spill_.size(), !more};
+        }
+        cur_ = buf;
+        prev_ = block.data;
+        prev_size_ = block.size;
+        // Хвост из другого буфера уже перенесён — его можно заполнять
+        if (more) issue(1 - buf);
+        return true;
+    }
+
+private:
+    static constexpr std::size_t kHeadroom = std::size_t(64) << 10;
+
+    struct Request {
+        bool pending = false;
+        bool failed = false;
+        int error = 0;  // errno потока чтения при failed
+        int buffer = 0;
+        std::uint64_t pos = 0;
+        std::size_t size = 0;
+        std::size_t got = 0;
+    };
+
+    void issue(int buf) {
+        std::size_t n = std::size_t(std::min<std::uint64_t>(kBlock, end_ - pos_));
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            req_ = Request{true, false, 0, buf, pos_, n, 0};
+        }
+        pos_ += n;
+        wake_io_.notify_one();
+    }
+
+    void wait_idle() {
+        std::unique_lock<std::mutex> lock(lock_);
+        io_done_.wait(lock, [&] { return !req_.pending; });
+    }
+
+    void io_loop() {
+        std::unique_lock<std::mutex> lock(lock_);
+        for (;;) {
+            wake_io_.wait(lock, [&] { return stop_ || req_.pending; });
+            if (stop_) return;
+            Request r = req_;
+            lock.unlock();
+            long long got = pread_full(fd_, buffers_[std::size_t(r.buffer)].get() + kHeadroom, r.size, r.pos);
+            int error = got < 0 ? errno : 0;
+            lock.lock();
+            req_.failed = got < 0;
+            req_.error = error;
+            req_.got = got < 0 ? 0 : std::size_t(got);
+            req_.pending = false;
+            io_done_.notify_one();
+        }
+    }
+
+    std::unique_ptr<char[]> buffers_[2];
+    std::vector<char> spill_;
+    int cur_ = -1;
+    const char* prev_ = nullptr;
+    std::size_t prev_size_ = 0;
+    std::uint64_t pos_ = 0;
+    std::uint64_t end_ = 0;
+
+    std::mutex lock_;
+    std::condition_variable wake_io_;
+    std::condition_variable io_done_;
+    Request req_;
+    bool stop_ = false;
+    std::thread io_;
+};
+
+// std::ifstream блоками по 1 MiB; хвост переносится в начало буфера
+class StreamReader : public ChunkReader {
+public:
+    bool open(const std::string& path) override {
+        in_.close();
+        in_.clear();
+        in_.open(path, std::ios::binary);
+        return bool(in_);
+    }
+
+    std::size_t read_at(std::uint64_t pos, char* dst, std::size_t n) override {
+        in_.clear();
+        in_.seekg(std::streamoff(pos));
+        in_.read(dst, std::streamsize(n));
+        return std::size_t(in_.gcount());
+    }
+
+    bool start(std::uint64_t begin, std::uint64_t end) override {
+        in_.clear();
+        in_.seekg(std::streamoff(begin));
+        left_ = end - begin;
+        filled_ = 0;
+        return bool(in_);
+    }
+
+    bool next(std::size_t keep, ReadBlock& block) override {
+        std::memmove(buffer_.data(), buffer_.data() + filled_ - keep, keep);
+        if (keep == buffer_.size()) buffer_.resize(buffer_.size() * 2);
+        std::size_t want = std::size_t(std::min<std::uint64_t>(left_, buffer_.size() - keep));
+        in_.read(buffer_.data() + keep, std::streamsize(want));
+        if (in_.bad()) return false;
+        std::size_t got = std::size_t(in_.gcount());
+        left_ = got < want ? 0 : left_ - got;
+        filled_ = keep + got;
+        block = ReadBlock{buffer_.data(), filled_, left_ == 0};
+        return true;
+    }
+
+private:
+    std::ifstream in_;
+    std::vector<char> buffer_ = std::vector<char>(kBlock);
+    std::uint64_t left_ = 0;
+    std::size_t filled_ = 0;
+};
+
+} // namespace
+
+std::unique_ptr<ChunkReader> make_reader(IoMode mode) {
+    switch (mode) {
+    case IoMode::Mmap: return std::make_unique<MmapReader>();
+    case IoMode::Pread: return std::make_unique<PreadReader>();
+    case IoMode::Stream: return std::make_unique<StreamReader>();
+    }
+    return nullptr;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Способ чтения файлов индексатором
+enum class IoMode { Mmap, Pread, Stream };
+
+const char* io_mode_name(IoMode mode);
+bool parse_io_mode(const std::string& name, IoMode& mode);
+
+// Блок отрезка файла. Байты можно менять на месте: токенизатор приводит
+// слова к нижнему регистру прямо в блоке.
+struct ReadBlock {
+    char* data = nullptr;
+    std::size_t size = 0;
+    bool last = false;
+};
+
+// Читатель отрезков файла; один на рабочий поток, переиспользуется между
+// задачами. Ошибки — false, причина в errno.
+class ChunkReader {
+public:
+    virtual ~ChunkReader() = default;
+
+    virtual bool open(const std::string& path) = 0;
+
+    // До n байт с позиции pos: нужно, чтобы сдвинуть границы отрезка на
+    // границы слов. Меньше n — конец файла.
+    virtual std::size_t read_at(std::uint64_t pos, char* dst, std::size_t n) = 0;
+
+    // Начинает последовательное чтение [begin, end)
+    virtual bool start(std::uint64_t begin, std::uint64_t end) = 0;
+
+    // Следующий блок. Его первые keep байт — последние keep байт
+    // предыдущего блока (слово, разрезанное границей блока). Предыдущий
+    // блок после вызова недействителен.
+    virtual bool next(std::size_t keep, ReadBlock& block) = 0;
+};
+
+std::unique_ptr<ChunkReader> make_reader(IoMode mode);
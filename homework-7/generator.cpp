@@ -1,16 +1,24 @@
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
-#include <fstream>
-#include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <random>
-#include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace fs = std::filesystem;
 
 struct Args {
@@ -19,9 +27,11 @@ struct Args {
     int mib_per_file = 5;
     int vocab = 2000;
     double skew = 1.2;      // ~ Zipf exponent: 0 = равномерно, 1..2 = сильно скошено
+    double size_skew = 0.0; // то же для размеров файлов: 0 = все по --mib
     uint64_t seed = 0;      // 0 => по времени
     int min_word_len = 3;
     int max_word_len = 12;
+    int threads = 1;
 };
 
 static void print_usage(const char* prog) {
@@ -33,11 +43,14 @@ static void print_usage(const char* prog) {
         "  --mib SIZE        size per file in MiB (default: 5)\n"
         "  --vocab V         vocabulary size (default: 2000)\n"
         "  --skew S          frequency skew (default: 1.2)\n"
+        "  --size-skew Z     file size skew, 0 = all files --mib; total stays files*mib (default: 0)\n"
         "  --seed X          random seed, 0 = time-based (default: 0)\n"
         "  --minlen L        min generated word length (default: 3)\n"
         "  --maxlen L        max generated word length (default: 12)\n"
+        "  --threads T       files generated in parallel; output does not depend on T (default: 1)\n"
         "\nExamples:\n"
-        "  " << prog << " --out data --files 100 --mib 20 --vocab 50000 --skew 1.3 --seed 42\n";
+        "  " << prog << " --out data --files 100 --mib 20 --vocab 50000 --skew 1.3 --seed 42\n"
+        "  " << prog << " --out data --files 50 --mib 20 --size-skew 1.5   # a few giant files, many tiny ones\n";
 }
 
 static bool starts_with(std::string_view s, std::string_view pref) {
@@ -68,12 +81,16 @@ static bool parse_args(int argc, char** argv, Args& a) {
             a.vocab = std::stoi(need("--vocab"));
         } else if (key == "--skew") {
             a.skew = std::stod(need("--skew"));
+        } else if (key == "--size-skew") {
+            a.size_skew = std::stod(need("--size-skew"));
         } else if (key == "--seed") {
             a.seed = static_cast<uint64_t>(std::stoull(need("--seed")));
         } else if (key == "--minlen") {
             a.min_word_len = std::stoi(need("--minlen"));
         } else if (key == "--maxlen") {
             a.max_word_len = std::stoi(need("--maxlen"));
+        } else if (key == "--threads") {
+            a.threads = std::stoi(need("--threads"));
         } else {
             std::cerr << "Unknown option: " << key << "\n";
             print_usage(argv[0]);
@@ -84,6 +101,14 @@ static bool parse_args(int argc, char** argv, Args& a) {
         std::cerr << "files/mib/vocab must be > 0\n";
         std::exit(2);
     }
+    if (a.threads < 1) {
+        std::cerr << "threads must be >= 1\n";
+        std::exit(2);
+    }
+    if (a.size_skew < 0) {
+        std::cerr << "size-skew must be >= 0\n";
+        std::exit(2);
+    }
     if (a.min_word_len < 1 || a.max_word_len < a.min_word_len) {
         std::cerr << "Invalid minlen/maxlen\n";
         std::exit(2);
@@ -91,62 +116,215 @@ static bool parse_args(int argc, char** argv, Args& a) {
     return true;
 }
 
+// splitmix64: из --seed и номера файла получается независимое зерно
+// файла, так что содержимое файла не зависит от числа потоков
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// Равномерно в [lo, hi]: старшие 32 бита, умноженные на длину диапазона
+static int uniform(std::mt19937_64& rng, int lo, int hi) {
+    return lo + int(((rng() >> 32) * uint64_t(hi - lo + 1)) >> 32);
+}
+
+// Выбор по весам за O(1) методом алиасов (Walker, Vose): в корзине i
+// с вероятностью prob[i] остаётся i, иначе берётся alias[i]
+class AliasTable {
+public:
+    explicit AliasTable(const std::vector<double>& weights) : prob_(weights.size()), alias_(weights.size()) {
+        const size_t n = weights.size();
+        double sum = 0;
+        for (double w : weights) sum += w;
+        std::vector<double> scaled(n);
+        std::vector<uint32_t> small, large;
+        for (size_t i = 0; i < n; i++) {
+            scaled[i] = weights[i] * double(n) / sum;
+            (scaled[i] < 1.0 ? small : large).push_back(uint32_t(i));
+        }
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back(), l = large.back();
+            small.pop_back();
+            prob_[s] = to_threshold(scaled[s]);
+            alias_[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Остатки из-за округления — полные корзины
+        for (uint32_t i : large) prob_[i] = UINT32_MAX, alias_[i] = i;
+        for (uint32_t i : small) prob_[i] = UINT32_MAX, alias_[i] = i;
+    }
+
+    // Одно 64-битное число: старшая половина выбирает корзину, младшая — монету
+    size_t operator()(std::mt19937_64& rng) const {
+        uint64_t r = rng();
+        size_t i = size_t(((r >> 32) * uint64_t(prob_.size())) >> 32);
+        return uint32_t(r) < prob_[i] ? i : alias_[i];
+    }
+
+private:
+    static uint32_t to_threshold(double p) {
+        return p >= 1.0 ? UINT32_MAX : uint32_t(p * 4294967296.0);
+    }
+
+    std::vector<uint32_t> prob_;
+    std::vector<uint32_t> alias_;
+};
+
 static std::string rand_word(std::mt19937_64& rng, int minlen, int maxlen) {
     static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz";
-    std::uniform_int_distribution<int> len_dist(minlen, maxlen);
-    std::uniform_int_distribution<int> ch_dist(0, 25);
-
-    int len = len_dist(rng);
+    int len = uniform(rng, minlen, maxlen);
     std::string w;
     w.reserve(static_cast<size_t>(len));
-    for (int i = 0; i < len; i++) w.push_back(alphabet[ch_dist(rng)]);
+    for (int i = 0; i < len; i++) w.push_back(alphabet[uniform(rng, 0, 25)]);
     return w;
 }
 
-static std::string maybe_mutate(std::mt19937_64& rng, const std::string& base) {
-    // Добавляем "логовый" шум: цифры, _, Camel-ish, смесь
-    std::uniform_int_distribution<int> p(0, 99);
-    int x = p(rng);
-    if (x < 70) return base; // чаще без мутации
-
-    std::string w = base;
-    if (x < 80) {
-        // суффикс _123 или _ab12
-        std::uniform_int_distribution<int> d(0, 9999);
-        w += "_";
-        w += std::to_string(d(rng));
+// Строки собираются прямо в буфер файла, числа — через std::to_chars
+class LineBuffer {
+public:
+    explicit LineBuffer(size_t capacity) { data_.reserve(capacity); }
+
+    void put(std::string_view s) { data_.append(s); }
+    void put(char c) { data_.push_back(c); }
+
+    void put_uint(uint64_t x) {
+        char buf[20];
+        auto res = std::to_chars(buf, buf + sizeof(buf), x);
+        data_.append(buf, size_t(res.ptr - buf));
+    }
+
+    std::string& str() { return data_; }
+
+private:
+    std::string data_;
+};
+
+// Слово словаря с "логовым" шумом: цифры, _, Camel-ish, смесь
+static void put_word(std::mt19937_64& rng, const std::string& base, LineBuffer& out) {
+    int x = uniform(rng, 0, 99);
+    if (x < 70 || base.empty()) {
+        out.put(base); // чаще без мутации
+    } else if (x < 80) {
+        // суффикс _123
+        out.put(base);
+        out.put('_');
+        out.put_uint(uint64_t(uniform(rng, 0, 9999)));
     } else if (x < 90) {
         // вставка цифры внутрь
-        if (!w.empty()) {
-            std::uniform_int_distribution<size_t> pos(0, w.size() - 1);
-            std::uniform_int_distribution<int> dig(0, 9);
-            w.insert(w.begin() + static_cast<std::ptrdiff_t>(pos(rng)), char('0' + dig(rng)));
-        }
+        size_t pos = size_t(uniform(rng, 0, int(base.size()) - 1));
+        out.put(std::string_view(base).substr(0, pos));
+        out.put(char('0' + uniform(rng, 0, 9)));
+        out.put(std::string_view(base).substr(pos));
     } else {
         // "слегка" поменять регистр
-        if (!w.empty()) w[0] = char(std::toupper(static_cast<unsigned char>(w[0])));
+        out.put(char(std::toupper(static_cast<unsigned char>(base[0]))));
+        out.put(std::string_view(base).substr(1));
     }
-    return w;
 }
 
-static std::string rand_ip(std::mt19937_64& rng) {
-    std::uniform_int_distribution<int> b(1, 254);
-    std::ostringstream oss;
-    oss << b(rng) << "." << b(rng) << "." << b(rng) << "." << b(rng);
-    return oss.str();
+static void put_ip(std::mt19937_64& rng, LineBuffer& out) {
+    for (int i = 0; i < 4; i++) {
+        if (i > 0) out.put('.');
+        out.put_uint(uint64_t(uniform(rng, 1, 254)));
+    }
 }
 
-static std::string rand_level(std::mt19937_64& rng) {
-    static const char* levels[] = {"INFO", "WARN", "ERROR", "DEBUG", "TRACE"};
-    // Смещаем вероятности: INFO чаще
-    std::discrete_distribution<int> d({50, 15, 12, 18, 5});
-    return levels[d(rng)];
+static std::string_view rand_punct(std::mt19937_64& rng) {
+    static const char* p[] = {" ", " ", " ", " ", " ", " - ", " | ", " : ", " :: ", ", ", "; ", "  "};
+    return p[uniform(rng, 0, int(sizeof(p) / sizeof(p[0]) - 1))];
 }
 
-static std::string rand_punct(std::mt19937_64& rng) {
-    static const char* p[] = {" ", " ", " ", " ", " ", " - ", " | ", " : ", " :: ", ", ", "; ", "  "};
-    std::uniform_int_distribution<int> d(0, (int)(sizeof(p)/sizeof(p[0]) - 1));
-    return p[d(rng)];
+// Общие для всех файлов словарь и распределения
+struct Corpus {
+    std::vector<std::string> vocab;
+    AliasTable pick_word;
+    AliasTable pick_level;
+};
+
+static const char* const kLevels[] = {"INFO", "WARN", "ERROR", "DEBUG", "TRACE"};
+
+// Пишет ровно bytes байт строк лога в path; false — ошибка (errno)
+static bool generate_file(const Corpus& c, int fi, uint64_t bytes, uint64_t seed, const fs::path& path) {
+    std::mt19937_64 rng(splitmix64(seed ^ splitmix64(uint64_t(fi))));
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    constexpr size_t kFlush = size_t(1) << 20;
+    LineBuffer line(kFlush + 4096);
+    std::string& buffer = line.str();
+    uint64_t written = 0;
+    uint64_t base_ts = 1700000000ull + uint64_t(fi) * 12345ull; // псевдо-epoch
+
+    auto flush = [&]() {
+        for (size_t done = 0; done < buffer.size();) {
+            ssize_t got = ::write(fd, buffer.data() + done, buffer.size() - done);
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0) return false;
+            done += size_t(got);
+        }
+        written += buffer.size();
+        buffer.clear();
+        return true;
+    };
+
+    bool ok = true;
+    while (ok && written < bytes) {
+        // Таймстемп + уровень + ip + код
+        uint64_t ts = base_ts + ((written + buffer.size()) / 200); // слегка растёт
+        line.put_uint(ts);
+        line.put(rand_punct(rng));
+        line.put(kLevels[c.pick_level(rng)]);
+        line.put(rand_punct(rng));
+        line.put("ip=");
+        put_ip(rng, line);
+        line.put(rand_punct(rng));
+        line.put("code=");
+        line.put_uint(uint64_t(uniform(rng, 100, 599))); // http-like codes
+        line.put(rand_punct(rng));
+
+        int wc = uniform(rng, 6, 18); // слов в сообщении
+        for (int i = 0; i < wc; i++) {
+            put_word(rng, c.vocab[c.pick_word(rng)], line);
+
+            // иногда вставим path-like токен: /api/v1/<word>/<word>?id=123
+            if (uniform(rng, 0, 99) < 6) {
+                line.put(rand_punct(rng));
+                line.put("/api/v1/");
+                line.put(c.vocab[c.pick_word(rng)]);
+                line.put('/');
+                line.put(c.vocab[c.pick_word(rng)]);
+                line.put("?id=");
+                line.put_uint(uint64_t(uniform(rng, 1, 2000000)));
+            }
+
+            // иногда вставим пунктуацию, чтобы токенизация была не тривиальной
+            if (i + 1 < wc) line.put(uniform(rng, 0, 99) < 12 ? ", " : " ");
+        }
+
+        // добавим user_id и "tag"
+        line.put(rand_punct(rng));
+        line.put("user_");
+        line.put_uint(uint64_t(uniform(rng, 1, 2000000)));
+        line.put(rand_punct(rng));
+        line.put("[tag_");
+        line.put_uint(uint64_t(uniform(rng, 1, 2000000) % 1000));
+        line.put("]\n");
+
+        if (buffer.size() >= kFlush || written + buffer.size() >= bytes) ok = flush();
+    }
+    // Последняя строка выходит за цель не больше чем на свою длину;
+    // хвост отрезается на месте
+    if (ok && written > bytes && ::ftruncate(fd, off_t(bytes)) != 0) ok = false;
+    int saved = errno;
+    if (::close(fd) != 0 && ok) return false;
+    errno = saved;
+    return ok;
 }
 
 int main(int argc, char** argv) {
@@ -171,148 +349,63 @@ int main(int argc, char** argv) {
         vocab.push_back(rand_word(rng, a.min_word_len, a.max_word_len));
     }
 
-    // 2) Распределение частот: вес ~ 1/(rank^skew)
-    //    discrete_distribution принимает веса double.
+    // 2) Распределение частот: вес ~ 1/(rank^skew); уровни — INFO чаще
     std::vector<double> weights;
     weights.reserve((size_t)a.vocab);
     for (int i = 0; i < a.vocab; i++) {
         double rank = double(i + 1);
-        double w = 1.0 / std::pow(rank, std::max(0.0, a.skew));
-        weights.push_back(w);
+        weights.push_back(1.0 / std::pow(rank, std::max(0.0, a.skew)));
+    }
+    const Corpus corpus{std::move(vocab), AliasTable(weights), AliasTable({50, 15, 12, 18, 5})};
+
+    // Размеры файлов: вес ~ 1/(rank^size_skew), сумма = files * mib.
+    // Ранги перемешаны, чтобы гигантский файл не всегда был первым.
+    const uint64_t bytes_total = uint64_t(a.files) * uint64_t(a.mib_per_file) * 1024ull * 1024ull;
+    std::vector<double> size_weights;
+    double size_weight_sum = 0;
+    for (int i = 0; i < a.files; i++) {
+        size_weights.push_back(1.0 / std::pow(double(i + 1), a.size_skew));
+        size_weight_sum += size_weights.back();
+    }
+    std::shuffle(size_weights.begin(), size_weights.end(), rng);
+    std::vector<uint64_t> file_bytes;
+    for (double w : size_weights) {
+        file_bytes.push_back(std::max<uint64_t>(1, uint64_t(double(bytes_total) * w / size_weight_sum)));
     }
-    std::discrete_distribution<int> pick_word(weights.begin(), weights.end());
-
-    // 3) Параметры "лог-строки"
-    std::uniform_int_distribution<int> msg_words(6, 18);     // слов в сообщении
-    std::uniform_int_distribution<int> maybe_comma(0, 99);   // иногда вставлять пунктуацию
-    std::uniform_int_distribution<int> maybe_path(0, 99);    // иногда вставлять path-like токен
-    std::uniform_int_distribution<int> code_dist(100, 599);  // http-like codes
-    std::uniform_int_distribution<int> user_id(1, 2000000);
-
-    auto make_path_token = [&](std::mt19937_64& r) -> std::string {
-        // /api/v1/<word>/<word>?id=123
-        std::ostringstream oss;
-        oss << "/api/v1/";
-        oss << vocab[(size_t)pick_word(r)] << "/";
-        oss << vocab[(size_t)pick_word(r)] << "?id=" << user_id(r);
-        return oss.str();
-    };
-
-    const uint64_t bytes_target_per_file = uint64_t(a.mib_per_file) * 1024ull * 1024ull;
 
     std::cout << "Generating into: " << out.string() << "\n"
               << "Seed: " << seed << "\n"
-              << "Files: " << a.files << ", ~" << a.mib_per_file << " MiB each\n"
-              << "Vocab: " << a.vocab << ", Skew: " << a.skew << "\n";
-
-    // 4) Генерим файлы
-    for (int fi = 0; fi < a.files; fi++) {
-        std::ostringstream fname;
-        fname << "log_" << std::setw(4) << std::setfill('0') << fi << ".txt";
-        fs::path path = out / fname.str();
-
-        std::ofstream ofs(path, std::ios::binary);
-        if (!ofs) {
-            std::cerr << "Failed to open: " << path.string() << "\n";
-            return 1;
-        }
-
-        // Крупный буфер для ускорения записи
-        std::string buffer;
-        buffer.reserve(1 << 20); // ~1MB
-
-        uint64_t written = 0;
-        uint64_t base_ts = 1700000000ull + uint64_t(fi) * 12345ull; // псевдо-epoch
-
-        while (written < bytes_target_per_file) {
-            // Таймстемп + уровень + ip + код
-            uint64_t ts = base_ts + (written / 200); // слегка растёт
-            buffer += std::to_string(ts);
-            buffer += rand_punct(rng);
-            buffer += rand_level(rng);
-            buffer += rand_punct(rng);
-            buffer += "ip=" + rand_ip(rng);
-            buffer += rand_punct(rng);
-            buffer += "code=" + std::to_string(code_dist(rng));
-            buffer += rand_punct(rng);
-
-            int wc = msg_words(rng);
-            for (int i = 0; i < wc; i++) {
-                int idx = pick_word(rng);
-                std::string w = maybe_mutate(rng, vocab[(size_t)idx]);
-                buffer += w;
-
-                if (maybe_path(rng) < 6) {
-                    buffer += rand_punct(rng);
-                    buffer += make_path_token(rng);
-                }
-
-                // иногда вставим пунктуацию, чтобы токенизация была не тривиальной
-                if (i + 1 < wc) {
-                    if (maybe_comma(rng) < 12) buffer += ", ";
-                    else buffer += " ";
-                }
-            }
-
-            // добавим user_id и "tag"
-            buffer += rand_punct(rng);
-            buffer += "user_" + std::to_string(user_id(rng));
-            buffer += rand_punct(rng);
-            buffer += "[tag_" + std::to_string(user_id(rng) % 1000) + "]";
-            buffer += "\n";
-
-            // если буфер разросся — сбросим в файл
-            if (buffer.size() >= (1 << 20)) {
-                ofs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-                written += buffer.size();
-                buffer.clear();
+              << "Files: " << a.files << ", ~" << a.mib_per_file << " MiB ";
+    if (a.size_skew > 0) std::cout << "on average, size skew " << a.size_skew << "\n";
+    else std::cout << "each\n";
+    std::cout << "Vocab: " << a.vocab << ", Skew: " << a.skew << ", Threads: " << a.threads << "\n";
+
+    // 3) Генерим файлы: потоки разбирают номера файлов по очереди.
+    // Содержимое файла зависит только от seed и номера, так что результат
+    // одинаков при любом --threads; меняется лишь порядок строк "wrote".
+    std::atomic<int> next{0};
+    std::atomic<bool> failed{false};
+    std::mutex print_lock;
+    auto work = [&] {
+        for (int fi; !failed && (fi = next.fetch_add(1)) < a.files;) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "log_%04d.txt", fi);
+            fs::path path = out / name;
+            if (!generate_file(corpus, fi, file_bytes[(size_t)fi], seed, path)) {
+                std::lock_guard<std::mutex> guard(print_lock);
+                std::cerr << "Failed to write " << path.string() << ": " << std::strerror(errno) << "\n";
+                failed = true;
+                return;
             }
+            std::lock_guard<std::mutex> guard(print_lock);
+            std::cout << "  wrote " << name << " (" << file_bytes[(size_t)fi] / 1024 << " KiB)\n";
         }
-
-        // Допишем остаток
-        if (!buffer.empty()) {
-            ofs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-            written += buffer.size();
-            buffer.clear();
-        }
-
-        ofs.close();
-
-        // подрежем файл точно до цели (чтобы размеры были ровнее)
-        // (не обязательно, но удобно)
-        try {
-            auto sz = fs::file_size(path);
-            if (sz > bytes_target_per_file) {
-                // Быстро "обрежем": перепишем в новый файл нужное количество
-                fs::path tmp = path;
-                tmp += ".tmp";
-
-                std::ifstream ifs(path, std::ios::binary);
-                std::ofstream tfs(tmp, std::ios::binary);
-
-                std::vector<char> chunk(1 << 20);
-                uint64_t remain = bytes_target_per_file;
-                while (remain > 0 && ifs) {
-                    auto to_read = (size_t)std::min<uint64_t>(chunk.size(), remain);
-                    ifs.read(chunk.data(), (std::streamsize)to_read);
-                    auto got = (size_t)ifs.gcount();
-                    if (got == 0) break;
-                    tfs.write(chunk.data(), (std::streamsize)got);
-                    remain -= got;
-                }
-                ifs.close();
-                tfs.close();
-
-                fs::remove(path);
-                fs::rename(tmp, path);
-            }
-        } catch (...) {
-            // если не получилось — не критично
-        }
-
-        std::cout << "  wrote " << path.filename().string()
-                  << " (" << (fs::file_size(path) / 1024) << " KiB)\n";
-    }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < std::min(a.threads, a.files); t++) pool.emplace_back(work);
+    work();
+    for (std::thread& t : pool) t.join();
+    if (failed) return 1;
 
     std::cout << "Done.\n";
     return 0;
@@ -0,0 +1,207 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "word_table.hpp"
+
+// Count-Min Sketch: depth строк по width счётчиков. Оценка частоты —
+// минимум по строкам; она не меньше истинной и с вероятностью 1 - delta
+// превышает её не больше чем на eps * N, где N — число всех слов,
+// eps = e / width, delta = exp(-depth). Индексы строк — двойное
+// хеширование от одного 64-битного хеша слова.
+class CountMinSketch {
+public:
+    CountMinSketch(double eps, double delta) {
+        std::size_t width = 16;
+        while (double(width) < std::exp(1.0) / eps) width <<= 1;
+        depth_ = std::max<std::size_t>(1, std::size_t(std::ceil(std::log(1.0 / delta))));
+        mask_ = width - 1;
+        counts_.assign(depth_ * width, 0);
+    }
+
+    void add(std::uint64_t hash, std::uint64_t n = 1) {
+        std::uint64_t step = (hash >> 32 | hash << 32) | 1;
+        for (std::size_t row = 0; row < depth_; row++, hash += step) counts_[row * width() + (hash & mask_)] += n;
+        total_ += n;
+    }
+
+    std::uint64_t estimate(std::uint64_t hash) const {
+        std::uint64_t step = (hash >> 32 | hash << 32) | 1;
+        std::uint64_t best = UINT64_MAX;
+        for (std::size_t row = 0; row < depth_; row++, hash += step)
+            best = std::min(best, counts_[row * width() + (hash & mask_)]);
+        return best;
+    }
+
+    // Скетчи одинаковых размеров складываются поэлементно
+    void merge(const CountMinSketch& other) {
+        for (std::size_t i = 0; i < counts_.size(); i++) counts_[i] += other.counts_[i];
+        total_ += other.total_;
+    }
+
+    std::size_t width() const { return mask_ + 1; }
+    std::size_t depth() const { return depth_; }
+    double eps() const { return std::exp(1.0) / double(width()); }
+    double delta() const { return std::exp(-double(depth_)); }
+    std::uint64_t total() const { return total_; }
+    std::size_t memory_bytes() const { return counts_.size() * sizeof(std::uint64_t); }
+
+private:
+    std::size_t depth_ = 0;
+    std::size_t mask_ = 0;
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t total_ = 0;
+};
+
+// Space-Saving (Metwally и др.): capacity отслеживаемых слов. Новое слово
+// при заполненной таблице вытесняет слово с наименьшим счётчиком c и
+// получает счётчик c + 1 с ошибкой c. Для отслеживаемого слова
+// count - error <= истинная частота <= count, а error <= N / capacity.
+// Минимум ищется кучей по счётчику.
+class SpaceSaving {
+public:
+    struct Entry {
+        std::string word;
+        std::uint64_t count = 0;
+        std::uint64_t error = 0;
+    };
+
+    explicit SpaceSaving(std::size_t capacity) : capacity_(std::max<std::size_t>(1, capacity)) {
+        entries_.reserve(capacity_);  // string_view в index_ указывают в entries_
+        heap_.reserve(capacity_);
+        index_.reserve(capacity_ * 2);
+    }
+
+    SpaceSaving(const SpaceSaving&) = delete;
+    SpaceSaving& operator=(const SpaceSaving&) = delete;
+
+    void add(std::string_view word, std::uint64_t n = 1) {
+        total_ += n;
+        auto it = index_.find(word);
+        if (it != index_.end()) {
+            Node& node = entries_[it->second];
+            node.entry.count += n;
+            sift_down(node.heap_pos);
+            return;
+        }
+        if (entries_.size() < capacity_) {
+            entries_.push_back(Node{Entry{std::string(word), n, 0}, heap_.size()});
+            heap_.push_back(entries_.size() - 1);
+            index_.emplace(entries_.back().entry.word, entries_.size() - 1);
+            sift_up(heap_.size() - 1);
+            return;
+        }
+        std::size_t victim = heap_[0];
+        Node& node = entries_[victim];
+        index_.erase(node.entry.word);
+        std::uint64_t floor = node.entry.count;
+        node.entry.word.assign(word);
+        node.entry.count = floor + n;
+        node.entry.error = floor;
+        index_.emplace(node.entry.word, victim);
+        sift_down(0);
+    }
+
+    // Наименьший счётчик, если таблица заполнена: столько могло быть у
+    // любого неотслеживаемого слова
+    std::uint64_t floor() const { return entries_.size() < capacity_ ? 0 : entries_[heap_[0]].entry.count; }
+
+    std::uint64_t total() const { return total_; }
+    std::size_t capacity() const { return capacity_; }
+
+    // Слияние сводок по Agarwal и др.: частота слова, которого нет в одной
+    // из сводок, берётся равной её floor(); остаются capacity наибольших.
+    // Гарантия error <= N / capacity сохраняется для суммарного N.
+    void merge(const SpaceSaving& other) {
+        std::unordered_map<std::string, Entry> all;
+        for (const Node& n : entries_) all.emplace(n.entry.word, Entry{n.entry.word, n.entry.count, n.entry.error});
+        std::uint64_t mine = floor(), theirs = other.floor();
+        for (auto& [word, e] : all) {
+            e.count += theirs;
+            e.error += theirs;
+        }
+        for (const Node& n : other.entries_) {
+            auto it = all.find(n.entry.word);
+            if (it != all.end()) {
+                it->second.count += n.entry.count - theirs;
+                it->second.error += n.entry.error - theirs;
+            } else {
+                all.emplace(n.entry.word, Entry{n.entry.word, n.entry.count + mine, n.entry.error + mine});
+            }
+        }
+        std::vector<Entry> merged;
+        merged.reserve(all.size());
+        for (auto& [word, e] : all) merged.push_back(std::move(e));
+        std::size_t keep = std::min(capacity_, merged.size());
+        std::partial_sort(merged.begin(), merged.begin() + std::ptrdiff_t(keep), merged.end(),
+                          [](const Entry& x, const Entry& y) { return x.count > y.count; });
+        merged.resize(keep);
+
+        std::uint64_t total = total_ + other.total_;
+        entries_.clear();
+        heap_.clear();
+        index_.clear();
+        for (Entry& e : merged) {
+            entries_.push_back(Node{std::move(e), heap_.size()});
+            heap_.push_back(entries_.size() - 1);
+            sift_up(heap_.size() - 1);
+        }
+        for (std::size_t i = 0; i < entries_.size(); i++) index_.emplace(entries_[i].entry.word, i);
+        total_ = total;
+    }
+
+    // fn(const Entry&)
+    template<class Fn>
+    void for_each(Fn&& fn) const {
+        for (const Node& n : entries_) fn(n.entry);
+    }
+
+private:
+    struct Node {
+        Entry entry;
+        std::size_t heap_pos;
+    };
+
+    struct ViewHash {
+        std::size_t operator()(std::string_view s) const { return std::size_t(hash_word(s)); }
+    };
+
+    bool less(std::size_t a, std::size_t b) const { return entries_[heap_[a]].entry.count < entries_[heap_[b]].entry.count; }
+
+    void swap_nodes(std::size_t a, std::size_t b) {
+        std::swap(heap_[a], heap_[b]);
+        entries_[heap_[a]].heap_pos = a;
+        entries_[heap_[b]].heap_pos = b;
+    }
+
+    void sift_up(std::size_t i) {
+        while (i > 0 && less(i, (i - 1) / 2)) {
+            swap_nodes(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+
+    void sift_down(std::size_t i) {
+        for (;;) {
+            std::size_t l = 2 * i + 1, r = l + 1, m = i;
+            if (l < heap_.size() && less(l, m)) m = l;
+            if (r < heap_.size() && less(r, m)) m = r;
+            if (m == i) return;
+            swap_nodes(i, m);
+            i = m;
+        }
+    }
+
+    std::size_t capacity_;
+    std::vector<Node> entries_;
+    std::vector<std::size_t> heap_;  // индексы entries_, наверху наименьший счётчик
+    std::unordered_map<std::string_view, std::size_t, ViewHash> index_;
+    std::uint64_t total_ = 0;
+};
@@ -0,0 +1,341 @@
+#include "index_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tokenizer.hpp"
+
+namespace {
+
+constexpr char kMagic[8] = {'L', 'O', 'G', 'I', 'N', 'D', 'E', 'X'};
+constexpr std::uint32_t kVersion = 2;  // 1 — хеш только первых и последних 4 KiB
+constexpr std::size_t kBuffer = std::size_t(1) << 20;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t minlen;
+    std::uint64_t files;
+    std::uint64_t files_offset;
+    std::uint64_t terms;
+    std::uint64_t terms_offset;
+    std::uint64_t offsets_offset;
+    std::uint64_t size;  // длина всего файла: обрезанный индекс не пройдёт проверку
+};
+static_assert(sizeof(Header) == 64, "index header layout");
+
+// Ровно n байт с позиции pos; false — ошибка или файл короче
+bool pread_exact(int fd, char* dst, std::size_t n, std::uint64_t pos) {
+    std::size_t done = 0;
+    while (done < n) {
+        ssize_t got = ::pread(fd, dst + done, n - done, off_t(pos + done));
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) return false;
+        if (got == 0) {
+            errno = EIO;
+            return false;
+        }
+        done += std::size_t(got);
+    }
+    return true;
+}
+
+// Читатель записей из отображённой памяти с проверкой границ
+struct Cursor {
+    const char* p;
+    const char* end;
+
+    template<class T>
+    bool get(T& value) {
+        if (std::size_t(end - p) < sizeof(T)) return false;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    bool get(std::string& s, std::size_t n) {
+        if (std::size_t(end - p) < n) return false;
+        s.assign(p, n);
+        p += n;
+        return true;
+    }
+};
+
+} // namespace
+
+namespace {
+
+constexpr std::uint64_t kHashMul = 0x9E3779B97F4A7C15ull;
+
+std::uint64_t avalanche(std::uint64_t h) {
+    h ^= h >> 32;
+    h *= kHashMul;
+    return h ^ (h >> 29);
+}
+
+} // namespace
+
+void ContentHash::mix(const char* p) {
+    for (int l = 0; l < 4; l++) {
+        std::uint64_t v;
+        std::memcpy(&v, p + 8 * l, 8);
+        lanes_[l] = (lanes_[l] ^ v) * kHashMul;
+        lanes_[l] ^= lanes_[l] >> 29;
+    }
+}
+
+void ContentHash::update(const char* p, std::size_t n) {
+    length_ += n;
+    if (pending_size_ > 0) {
+        std::size_t take = std::min(n, sizeof(pending_) - pending_size_);
+        std::memcpy(pending_ + pending_size_, p, take);
+        pending_size_ += take;
+        p += take;
+        n -= take;
+        if (pending_size_ < sizeof(pending_)) return;
+        mix(pending_);
+        pending_size_ = 0;
+    }
+    for (; n >= sizeof(pending_); p += sizeof(pending_), n -= sizeof(pending_)) mix(p);
+    std::memcpy(pending_, p, n);
+    pending_size_ = n;
+}
+
+std::uint64_t ContentHash::value() const {
+    ContentHash tail = *this;
+    if (tail.pending_size_ > 0) {
+        char last[sizeof(pending_)] = {};
+        std::memcpy(last, pending_, pending_size_);
+        tail.mix(last);
+    }
+    std::uint64_t h = length_ * kHashMul;
+    for (std::uint64_t lane : tail.lanes_) h = avalanche(h ^ lane);
+    return h;
+}
+
+bool hash_range(int fd, std::uint64_t begin, std::uint64_t end, ContentHash& hash) {
+    std::unique_ptr<char[]> buf(new char[kBuffer]);
+    for (std::uint64_t pos = begin; pos < end;) {
+        std::size_t n = std::size_t(std::min<std::uint64_t>(kBuffer, end - pos));
+        if (!pread_exact(fd, buf.get(), n, pos)) return false;
+        hash.update(buf.get(), n);
+        pos += n;
+    }
+    return true;
+}
+
+bool tail_start(int fd, std::uint64_t size, std::uint64_t& start) {
+    char buf[256];
+    start = size;
+    while (start > 0) {
+        std::size_t n = std::size_t(std::min<std::uint64_t>(start, sizeof(buf)));
+        if (!pread_exact(fd, buf, n, start - n)) return false;
+        for (std::size_t i = n; i > 0; i--) {
+            if (!is_word_char(static_cast<unsigned char>(buf[i - 1]))) return true;
+            start--;
+        }
+    }
+    return true;
+}
+
+IndexFile::~IndexFile() {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+}
+
+bool IndexFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        int saved = errno;
+        ::close(fd);
+        errno = saved;
+        return false;
+    }
+    size_ = std::size_t(st.st_size);
+    if (size_ < sizeof(Header)) {
+        ::close(fd);
+        errno = EINVAL;
+        return false;
+    }
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    int saved = errno;
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        errno = saved;
+        return false;
+    }
+    data_ = static_cast<const char*>(p);
+
+    Header h;
+    std::memcpy(&h, data_, sizeof(h));
+    bool ok = std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 && h.version == kVersion && h.size == size_ &&
+              h.files_offset >= sizeof(Header) && h.files_offset <= h.terms_offset &&
+              h.terms_offset <= h.offsets_offset && h.offsets_offset <= size_ && h.offsets_offset % 8 == 0 &&
+              (size_ - h.offsets_offset) / 8 == h.terms;
+    Cursor c{data_ + (ok ? h.files_offset : 0), data_ + (ok ? h.terms_offset : 0)};
+    for (std::uint64_t i = 0; ok && i < h.files; i++) {
+        FileStamp f;
+        std::uint32_t len = 0;
+        ok = c.get(f.size) && c.get(f.mtime_ns) && c.get(f.hash) && c.get(f.tail_start) && c.get(len) &&
+             c.get(f.path, len);
+        if (ok) files_.push_back(std::move(f));
+    }
+    if (!ok) {
+        files_.clear();
+        errno = EINVAL;
+        return false;
+    }
+    minlen_ = h.minlen;
+    terms_ = std::size_t(h.terms);
+    terms_base_ = data_ + h.terms_offset;
+    offsets_ = reinterpret_cast<const std::uint64_t*>(data_ + h.offsets_offset);
+    // Записи слов проверяются один раз здесь, дальше читаются без проверок
+    std::uint64_t limit = h.offsets_offset - h.terms_offset;
+    for (std::size_t i = 0; i < terms_; i++) {
+        std::uint32_t len;
+        if (offsets_[i] + sizeof(len) > limit) ok = false;
+        else std::memcpy(&len, terms_base_ + offsets_[i], sizeof(len));
+        if (!ok || offsets_[i] + sizeof(len) + len + sizeof(std::uint64_t) > limit) {
+            errno = EINVAL;
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* IndexFile::record(std::size_t i) const { return terms_base_ + offsets_[i]; }
+
+std::string_view IndexFile::word(std::size_t i) const {
+    std::uint32_t len;
+    std::memcpy(&len, record(i), sizeof(len));
+    return std::string_view(record(i) + sizeof(len), len);
+}
+
+std::uint64_t IndexFile::count(std::size_t i) const {
+    std::string_view w = word(i);
+    std::uint64_t n;
+    std::memcpy(&n, w.data() + w.size(), sizeof(n));
+    return n;
+}
+
+std::uint64_t IndexFile::find(std::string_view w) const {
+    std::size_t lo = 0, hi = terms_;
+    while (lo < hi) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        if (word(mid) < w) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < terms_ && word(lo) == w ? count(lo) : 0;
+}
+
+IndexWriter::~IndexWriter() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        ::unlink(tmp_path_.c_str());
+    }
+}
+
+bool IndexWriter::open(const std::string& path, std::uint32_t minlen, const std::vector<FileStamp>& files) {
+    path_ = path;
+    tmp_path_ = path + ".tmp-" + std::to_string(::getpid());
+    fd_ = ::open(tmp_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) return false;
+    buf_.reserve(kBuffer);
+    minlen_ = minlen;
+    file_count_ = files.size();
+
+    // Заголовок пишется в commit, пока на его месте нули
+    Header h{};
+    if (!write(&h, sizeof(h))) return false;
+    for (const FileStamp& f : files) {
+        std::uint32_t len = std::uint32_t(f.path.size());
+        if (!write(&f.size, sizeof(f.size)) || !write(&f.mtime_ns, sizeof(f.mtime_ns)) ||
+            !write(&f.hash, sizeof(f.hash)) || !write(&f.tail_start, sizeof(f.tail_start)) ||
+            !write(&len, sizeof(len)) || !write(f.path.data(), f.path.size()))
+            return false;
+    }
+    terms_offset_ = pos_ + buf_.size();
+    return true;
+}
+
+bool IndexWriter::add(std::string_view word, std::uint64_t count) {
+    offsets_.push_back(pos_ + buf_.size() - terms_offset_);
+    std::uint32_t len = std::uint32_t(word.size());
+    return write(&len, sizeof(len)) && write(word.data(), word.size()) && write(&count, sizeof(count));
+}
+
+bool IndexWriter::commit() {
+    static const char zeros[8] = {};
+    std::uint64_t offsets_offset = pos_ + buf_.size();
+    std::size_t pad = std::size_t((8 - offsets_offset % 8) % 8);
+    if (!write(zeros, pad)) return false;
+    offsets_offset += pad;
+    if (!write(offsets_.data(), offsets_.size() * sizeof(std::uint64_t)) || !flush()) return false;
+
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.minlen = minlen_;
+    h.files = file_count_;
+    h.files_offset = sizeof(Header);
+    h.terms = offsets_.size();
+    h.terms_offset = terms_offset_;
+    h.offsets_offset = offsets_offset;
+    h.size = pos_;
+    if (::pwrite(fd_, &h, sizeof(h), 0) != ssize_t(sizeof(h))) return false;
+    if (::fsync(fd_) != 0) return false;
+    if (::close(fd_) != 0) {
+        fd_ = -1;
+        ::unlink(tmp_path_.c_str());
+        return false;
+    }
+    fd_ = -1;
+    if (::rename(tmp_path_.c_str(), path_.c_str()) != 0) {
+        int saved = errno;
+        ::unlink(tmp_path_.c_str());
+        errno = saved;
+        return false;
+    }
+    // rename попадает на диск вместе с каталогом
+    std::filesystem::path dir = std::filesystem::path(path_).parent_path();
+    int dir_fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+    return true;
+}
+
+bool IndexWriter::write(const void* p, std::size_t n) {
+    const char* c = static_cast<const char*>(p);
+    while (n > 0) {
+        if (buf_.size() == kBuffer && !flush()) return false;
+        std::size_t part = std::min(n, kBuffer - buf_.size());
+        buf_.insert(buf_.end(), c, c + part);
+        c += part;
+        n -= part;
+    }
+    return true;
+}
+
+bool IndexWriter::flush() {
+    std::size_t done = 0;
+    while (done < buf_.size()) {
+        ssize_t got = ::write(fd_, buf_.data() + done, buf_.size() - done);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) return false;
+        done += std::size_t(got);
+    }
+    pos_ += buf_.size();
+    buf_.clear();
+    return true;
+}
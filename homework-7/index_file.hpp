@@ -0,0 +1,125 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Сохранённый индекс для повторных запусков над тем же каталогом.
+// Хранит отпечатки проиндексированных файлов и итоговую таблицу
+// слово → частота, отсортированную по слову. Файл отображается в память
+// целиком и читается без разбора: таблица слов — записи подряд плюс
+// массив смещений, так что слово ищется двоичным поиском.
+//
+// Формат (порядок байт машины):
+//   Header, 64 байта
+//   files:   записи [u64 size][i64 mtime_ns][u64 hash][u64 tail_start][u32 len][путь]
+//   terms:   записи [u32 len][байты слова][u64 частота] по возрастанию слова
+//   offsets: u64 на слово — смещение записи от начала terms, выровнено на 8
+//
+// Новый индекс пишется во временный файл рядом, сбрасывается на диск
+// (fsync) и подменяет старый через rename, так что прерванный запуск
+// оставляет на диске прежний индекс целиком.
+
+// Отпечаток файла. path — относительно индексируемого каталога.
+struct FileStamp {
+    std::string path;
+    std::uint64_t size = 0;
+    std::int64_t mtime_ns = 0;
+    std::uint64_t hash = 0;        // ContentHash первых size байт
+    std::uint64_t tail_start = 0;  // начало слова, на котором обрывается файл, иначе size
+};
+
+// Потоковый 64-битный хеш содержимого (не криптографический): четыре
+// независимые полосы по 8 байт, так что считается быстрее чтения из кеша
+// страниц. Результат не зависит от того, какими кусками подавались
+// данные, а value() можно брать посреди потока: хеш прежнего размера
+// дописанного файла получается по пути к хешу нового.
+class ContentHash {
+public:
+    void update(const char* p, std::size_t n);
+    std::uint64_t value() const;
+
+private:
+    void mix(const char* p);  // 32 байта, по 8 в каждую полосу
+
+    std::uint64_t lanes_[4] = {0x243F6A8885A308D3ull, 0x13198A2E03707344ull, 0xA4093822299F31D0ull,
+                               0x082EFA98EC4E6C89ull};
+    char pending_[32] = {};
+    std::size_t pending_size_ = 0;
+    std::uint64_t length_ = 0;
+};
+
+// Добавляет в hash байты [begin, end) файла. false — ошибка или файл
+// короче end (errno).
+bool hash_range(int fd, std::uint64_t begin, std::uint64_t end, ContentHash& hash);
+
+// Начало последнего слова, если первые size байт файла кончаются внутри
+// слова (оно может продолжиться в дописанных данных), иначе size
+bool tail_start(int fd, std::uint64_t size, std::uint64_t& start);
+
+class IndexFile {
+public:
+    IndexFile() = default;
+    ~IndexFile();
+
+    IndexFile(const IndexFile&) = delete;
+    IndexFile& operator=(const IndexFile&) = delete;
+
+    // false — файла нет или он не прочитался (errno); повреждённый индекс
+    // тоже false, с errno = EINVAL
+    bool open(const std::string& path);
+
+    std::uint32_t minlen() const { return minlen_; }
+    const std::vector<FileStamp>& files() const { return files_; }
+
+    std::size_t terms() const { return terms_; }
+    std::string_view word(std::size_t i) const;
+    std::uint64_t count(std::size_t i) const;
+
+    // Частота слова, 0 — нет в индексе
+    std::uint64_t find(std::string_view word) const;
+
+private:
+    const char* record(std::size_t i) const;
+
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::uint32_t minlen_ = 0;
+    std::vector<FileStamp> files_;
+    std::size_t terms_ = 0;
+    const char* terms_base_ = nullptr;
+    const std::uint64_t* offsets_ = nullptr;
+};
+
+// Запись нового индекса: слова подаются по возрастанию, commit
+// сбрасывает данные на диск и атомарно подменяет файл path. Без commit
+// временный файл удаляется в деструкторе. Ошибки — false, причина в errno.
+class IndexWriter {
+public:
+    IndexWriter() = default;
+    ~IndexWriter();
+
+    IndexWriter(const IndexWriter&) = delete;
+    IndexWriter& operator=(const IndexWriter&) = delete;
+
+    bool open(const std::string& path, std::uint32_t minlen, const std::vector<FileStamp>& files);
+    bool add(std::string_view word, std::uint64_t count);
+    bool commit();
+
+    std::size_t terms() const { return offsets_.size(); }
+
+private:
+    bool write(const void* p, std::size_t n);
+    bool flush();
+
+    std::string path_;
+    std::string tmp_path_;
+    int fd_ = -1;
+    std::vector<char> buf_;
+    std::uint64_t pos_ = 0;  // смещение в файле конца buf_
+    std::uint64_t terms_offset_ = 0;
+    std::vector<std::uint64_t> offsets_;
+    std::uint32_t minlen_ = 0;
+    std::uint64_t file_count_ = 0;
+};
@@ -0,0 +1,802 @@
+// Многопоточный индексатор логов: частоты слов по всем файлам каталога.
+// Один поток-производитель обходит каталог и режет файлы на отрезки байт,
+// K потребителей читают отрезки, считают слова в локальных таблицах и
+// сливают их в общий индекс. Большой файл делится между всеми потоками,
+// так что один гигантский лог не оставляет остальных без работы.
+//
+// С --mem-limit таблицы потоков, переросшие бюджет, сбрасываются на диск
+// отсортированными прогонами и в конце сливаются потоково (spill.hpp).
+// С --approx точный подсчёт заменяют Count-Min Sketch и Space-Saving
+// (heavy_hitters.hpp): память не зависит от числа различных слов, а к
+// каждому слову выводится гарантированная нижняя граница частоты.
+//
+// Потоки ведут свои счётчики байт, слов и времени по стадиям (metrics.hpp):
+// на терминале stderr раз в 250 мс обновляется строка прогресса, а
+// --stats-json в конце пишет сводный отчёт.
+//
+// С --index частоты сохраняются в файл (index_file.hpp), и следующий
+// запуск разбирает только новые файлы и дописанные хвосты старых.
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "file_reader.hpp"
+#include "heavy_hitters.hpp"
+#include "index_file.hpp"
+#include "metrics.hpp"
+#include "mpmc_queue.hpp"
+#include "sharded_index.hpp"
+#include "spill.hpp"
+#include "tokenizer.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// strerror с общим статическим буфером не годится для рабочих потоков.
+// strerror_r бывает GNU (возвращает строку) и XSI (возвращает код) —
+// перегрузка выбирает нужный результат.
+[[maybe_unused]] static const char* strerror_result(const char* message, const char*) { return message; }
+[[maybe_unused]] static const char* strerror_result(int, const char* buf) { return buf; }
+
+static std::string error_text(int err) {
+    char buf[256] = "unknown error";
+    return strerror_result(strerror_r(err, buf, sizeof(buf)), buf);
+}
+
+struct Args {
+    int threads = 1;
+    std::size_t top = 10;
+    std::size_t minlen = 1;
+    std::uint64_t chunk_mib = 8;
+    IoMode io = IoMode::Stream;
+    std::uint64_t mem_limit_mib = 0;  // 0 — без ограничения
+    std::string tmp_dir;
+    bool approx = false;
+    double approx_eps = 1e-4;
+    double approx_delta = 1e-3;
+    std::size_t approx_k = 0;  // 0 — max(1024, 16 * top)
+    std::string stats_json;
+    bool progress = true;
+    std::string index;
+    std::string path;
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options] <path>\n"
+        "Counts word frequencies over all files under <path> and prints the most frequent ones.\n"
+        "Options:\n"
+        "  --threads K       worker threads, K >= 1 (default: 1)\n"
+        "  --top M           number of words to print, M >= 1 (default: 10)\n"
+        "  --minlen L        minimal word length, L >= 1 (default: 1)\n"
+        "  --chunk-mib C     split files into tasks of about C MiB, 0 = whole files (default: 8)\n"
+        "  --io MODE         file reading: mmap | pread (I/O thread per worker) | stream (default: stream)\n"
+        "  --mem-limit MIB   bound word tables to about MIB MiB, spilling sorted runs to disk (default: off)\n"
+        "  --tmp-dir DIR     directory for spilled runs (default: system temp directory)\n"
+        "  --approx          approximate counts: Count-Min Sketch + Space-Saving, prints\n"
+        "                    '<word> <estimate> <lower bound>' after a '#' line with error bounds\n"
+        "  --approx-eps E    Count-Min additive error as a fraction of all words (default: 1e-4)\n"
+        "  --approx-delta D  probability that the Count-Min bound fails (default: 1e-3)\n"
+        "  --approx-k K      words tracked by Space-Saving (default: max(1024, 16 * M))\n"
+        "  --index FILE      keep word counts in FILE; later runs read only new files and the\n"
+        "                    appended tails of known ones (exact mode only)\n"
+        "  --stats-json FILE write a JSON report: bytes, tokens, distinct words, queue depth,\n"
+        "                    time per stage (io, tokenize, hash, merge) and per-thread throughput\n"
+        "  --no-progress     do not draw the progress line (drawn only when stderr is a terminal)\n"
+        "\nExample:\n"
+        "  " << prog << " --threads 8 --top 20 --minlen 3 ./data\n";
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--threads") {
+            a.threads = std::stoi(need("--threads"));
+        } else if (key == "--top") {
+            a.top = std::stoull(need("--top"));
+        } else if (key == "--minlen") {
+            a.minlen = std::stoull(need("--minlen"));
+        } else if (key == "--chunk-mib") {
+            a.chunk_mib = std::stoull(need("--chunk-mib"));
+        } else if (key == "--io") {
+            std::string mode = need("--io");
+            if (!parse_io_mode(mode, a.io)) {
+                std::cerr << "Unknown io mode: " << mode << "\n";
+                std::exit(2);
+            }
+        } else if (key == "--mem-limit") {
+            a.mem_limit_mib = std::stoull(need("--mem-limit"));
+        } else if (key == "--tmp-dir") {
+            a.tmp_dir = need("--tmp-dir");
+        } else if (key == "--approx") {
+            a.approx = true;
+        } else if (key == "--approx-eps") {
+            a.approx_eps = std::stod(need("--approx-eps"));
+        } else if (key == "--approx-delta") {
+            a.approx_delta = std::stod(need("--approx-delta"));
+        } else if (key == "--approx-k") {
+            a.approx_k = std::stoull(need("--approx-k"));
+        } else if (key == "--index") {
+            a.index = need("--index");
+        } else if (key == "--stats-json") {
+            a.stats_json = need("--stats-json");
+        } else if (key == "--no-progress") {
+            a.progress = false;
+        } else if (!key.empty() && key[0] == '-') {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        } else {
+            a.path = key;
+        }
+    }
+    if (a.path.empty()) {
+        std::cerr << "Missing <path>\n";
+        print_usage(argv[0]);
+        std::exit(2);
+    }
+    if (a.threads < 1 || a.top < 1 || a.minlen < 1) {
+        std::cerr << "threads/top/minlen must be >= 1\n";
+        std::exit(2);
+    }
+    if (a.approx && a.mem_limit_mib > 0) {
+        std::cerr << "--approx and --mem-limit are exclusive\n";
+        std::exit(2);
+    }
+    if (!a.index.empty() && (a.approx || a.mem_limit_mib > 0)) {
+        std::cerr << "--index works only with exact counting (no --approx, --mem-limit)\n";
+        std::exit(2);
+    }
+    if (!(a.approx_eps > 0 && a.approx_eps < 1) || !(a.approx_delta > 0 && a.approx_delta < 1)) {
+        std::cerr << "approx-eps/approx-delta must be in (0, 1)\n";
+        std::exit(2);
+    }
+    if (a.approx_k == 0) a.approx_k = std::max<std::size_t>(1024, 16 * a.top);
+    return true;
+}
+
+// Задача — отрезок байт [begin, end) файла. Границы режутся без чтения
+// файла и могут попасть внутрь слова: отрезку принадлежат слова, которые
+// в нём начинаются (см. index_chunk). size — размер файла при обходе:
+// дальше него не читается, даже если файл успел вырасти.
+struct ChunkTask {
+    std::string path;
+    std::uint64_t begin = 0;
+    std::uint64_t end = 0;
+    std::uint64_t size = 0;
+};
+
+// Первая позиция >= pos, где стоит не символ слова (или limit)
+static std::uint64_t word_end(ChunkReader& reader, std::uint64_t pos, std::uint64_t limit) {
+    char block[256];
+    while (pos < limit) {
+        std::size_t want = std::size_t(std::min<std::uint64_t>(sizeof(block), limit - pos));
+        std::size_t got = reader.read_at(pos, block, want);
+        for (std::size_t i = 0; i < got; i++) {
+            if (!is_word_char(static_cast<unsigned char>(block[i]))) return pos + i;
+        }
+        pos += got;
+        if (got < want) break;
+    }
+    return pos;
+}
+
+// Блок разбирается кусками до kSlice байт: слова куска сначала
+// собираются в words, потом считаются, так что время токенизации и
+// хеширования меряется раздельно, а words не растёт с размером блока
+constexpr std::size_t kSlice = std::size_t(256) << 10;
+
+// Конец куска, начинающегося с pos: не дальше kSlice и не внутри слова
+// (слово длиннее kSlice попадает в кусок целиком)
+static std::size_t slice_end(const char* data, std::size_t pos, std::size_t cut) {
+    if (cut - pos <= kSlice) return cut;
+    std::size_t stop = pos + kSlice;
+    while (stop > pos && is_word_char(static_cast<unsigned char>(data[stop - 1]))) stop--;
+    if (stop > pos) return stop;
+    stop = pos + kSlice;
+    while (stop < cut && is_word_char(static_cast<unsigned char>(data[stop]))) stop++;
+    return stop;
+}
+
+// Разбирает отрезок файла блоками читателя в counts (add на слово,
+// after_block после каждого блока). Слово, разрезанное границей
+// блока, переносится в начало следующего. Границы отрезка сначала
+// сдвигаются на границы слов: начатое до begin слово досчитает предыдущий
+// отрезок, а слово, пересекающее end, дочитывается здесь.
+template<class Counter>
+static bool index_chunk(const ChunkTask& task, std::size_t minlen, ChunkReader& reader, Counter& counts,
+                        ThreadStats& stats, std::vector<std::string_view>& words) {
+    StageClock clock(stats);
+    if (!reader.open(task.path)) return false;
+
+    std::uint64_t begin = task.begin;
+    std::uint64_t end = task.end;
+    if (begin > 0) begin = std::max(begin, word_end(reader, begin - 1, task.size));
+    if (end > task.begin) end = std::max(end, word_end(reader, end - 1, task.size));
+    if (begin >= end) {
+        clock.lap(Stage::Io);
+        return true;
+    }
+    if (!reader.start(begin, end)) return false;
+
+    std::size_t keep = 0;
+    ReadBlock block;
+    do {
+        if (!reader.next(keep, block)) return false;
+        clock.lap(Stage::Io);
+        ThreadStats::bump(stats.bytes, block.size - keep);
+        // Последнее слово блока может продолжиться в следующем
+        std::size_t cut = block.size;
+        if (!block.last) {
+            while (cut > 0 && is_word_char(static_cast<unsigned char>(block.data[cut - 1]))) cut--;
+        }
+        for (std::size_t pos = 0; pos < cut;) {
+            std::size_t stop = slice_end(block.data, pos, cut);
+            words.clear();
+            for_each_word(block.data + pos, stop - pos, minlen, [&](std::string_view w) { words.push_back(w); });
+            clock.lap(Stage::Tokenize);
+            for (std::string_view w : words) counts.add(w);
+            clock.lap(Stage::Hash);
+            ThreadStats::bump(stats.tokens, words.size());
+            pos = stop;
+        }
+        keep = block.size - cut;
+        counts.after_block();
+        clock.lap(Stage::Merge);
+    } while (!block.last);
+    return true;
+}
+
+// Счётчики рабочего потока: add на каждое слово, after_block после блока
+// чтения, finish в конце работы потока.
+
+// Точный подсчёт: локальные шарды сливаются в общий индекс, когда
+// разрастаются, и в конце
+class ExactCounter {
+public:
+    ExactCounter(ShardedIndex& index, std::size_t worker) : index_(index), local_(index), worker_(worker) {}
+
+    void add(std::string_view word) { local_.add(word); }
+
+    void after_block() {
+        if (local_.size() >= kMergeThreshold) index_.merge(local_, worker_);
+    }
+
+    void finish() { index_.merge(local_, worker_); }
+
+private:
+    static constexpr std::size_t kMergeThreshold = std::size_t(1) << 20;
+
+    ShardedIndex& index_;
+    ShardedIndex::Local local_;
+    std::size_t worker_;
+};
+
+// Ограничение памяти: таблица, переросшая бюджет, уходит на диск прогоном.
+// Пустые шарды занимают floor байт и после сброса остаются, поэтому
+// бюджет — это рост сверх floor (spill_budget).
+class SpillCounter {
+public:
+    SpillCounter(const ShardedIndex& shape, RunStore& store, std::size_t budget, std::atomic<bool>& failed)
+        : local_(shape), floor_(local_.memory_bytes()), store_(store), budget_(budget), failed_(failed) {}
+
+    void add(std::string_view word) { local_.add(word); }
+
+    void after_block() {
+        if (local_.memory_bytes() - floor_ > budget_) spill();
+    }
+
+    void finish() { spill(); }
+
+private:
+    void spill() {
+        if (local_.size() == 0) return;
+        std::vector<std::pair<std::string_view, std::uint64_t>> words;
+        words.reserve(local_.size());
+        local_.for_each([&](std::string_view word, std::uint64_t count) { words.emplace_back(word, count); });
+        if (!store_.write_run(words)) {
+            std::cerr << "Cannot write spill run: " << error_text(errno) << "\n";
+            failed_ = true;
+        }
+        local_.clear();
+    }
+
+    ShardedIndex::Local local_;
+    std::size_t floor_;
+    RunStore& store_;
+    std::size_t budget_;
+    std::atomic<bool>& failed_;
+};
+
+// Приближённый подсчёт: скетч и сводка у каждого потока свои, в конце
+// складываются в общие
+struct ApproxSummary {
+    std::mutex lock;
+    std::unique_ptr<CountMinSketch> sketch;
+    std::unique_ptr<SpaceSaving> heavy;
+};
+
+class ApproxCounter {
+public:
+    ApproxCounter(const Args& a, ApproxSummary& summary)
+        : sketch_(std::make_unique<CountMinSketch>(a.approx_eps, a.approx_delta)),
+          heavy_(std::make_unique<SpaceSaving>(a.approx_k)), summary_(summary) {}
+
+    void add(std::string_view word) {
+        sketch_->add(hash_word(word));
+        heavy_->add(word);
+    }
+
+    void after_block() {}
+
+    void finish() {
+        std::lock_guard<std::mutex> guard(summary_.lock);
+        if (!summary_.sketch) {
+            summary_.sketch = std::move(sketch_);
+            summary_.heavy = std::move(heavy_);
+            return;
+        }
+        summary_.sketch->merge(*sketch_);
+        summary_.heavy->merge(*heavy_);
+    }
+
+private:
+    std::unique_ptr<CountMinSketch> sketch_;
+    std::unique_ptr<SpaceSaving> heavy_;
+    ApproxSummary& summary_;
+};
+
+constexpr std::size_t kQueueCapacity = 1024;
+
+// Ctrl+C в режиме --index: оставшиеся задачи пропускаются, а индекс на
+// диске остаётся прежним
+static std::atomic<bool> g_interrupted{false};
+
+// Обходит каталог: fn(путь, размер) для каждого обычного файла
+template<class Fn>
+static void walk_files(const Args& a, Fn&& fn) {
+    std::error_code ec;
+    auto options = fs::directory_options::skip_permission_denied;
+    for (fs::recursive_directory_iterator it(a.path, options, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code file_ec;
+        if (!it->is_regular_file(file_ec)) continue;
+        std::uint64_t size = it->file_size(file_ec);
+        if (file_ec) continue;
+        fn(it->path(), size);
+    }
+    if (ec) std::cerr << "Directory walk stopped: " << ec.message() << "\n";
+}
+
+// Источник задач для run_workers: все файлы каталога целиком
+static auto whole_files(const Args& a) {
+    return [&a](auto&& enqueue) {
+        walk_files(a, [&](const fs::path& path, std::uint64_t size) { enqueue(path.string(), 0, size, size); });
+    };
+}
+
+// Производитель вызывает source(enqueue), и enqueue(путь, begin, end,
+// размер файла) режет отрезок на задачи; K потоков разбирают их
+// счётчиками, которые создаёт make_counter(номер потока). distinct —
+// число различных слов для строки прогресса, -1 если неизвестно.
+template<class Source, class MakeCounter>
+static void run_workers(const Args& a, Metrics& metrics, Source&& source, std::function<long long()> distinct,
+                        MakeCounter&& make_counter) {
+    MpmcQueue<ChunkTask> queue(kQueueCapacity);
+
+    std::unique_ptr<ProgressLine> progress;
+    if (a.progress && ::isatty(STDERR_FILENO)) {
+        progress = std::make_unique<ProgressLine>(
+            metrics, [&queue] { return queue.size_approx(); }, kQueueCapacity, std::move(distinct));
+    }
+
+    const std::uint64_t chunk = a.chunk_mib << 20;
+    auto enqueue = [&](const std::string& path, std::uint64_t begin, std::uint64_t end, std::uint64_t size) {
+        if (g_interrupted.load(std::memory_order_relaxed)) return;
+        // Отрезок делится на равные части не больше chunk байт
+        std::uint64_t len = end - begin;
+        std::uint64_t parts = chunk == 0 ? 1 : std::max<std::uint64_t>(1, (len + chunk - 1) / chunk);
+        for (std::uint64_t p = 0; p < parts; p++) {
+            queue.push(ChunkTask{path, begin + len * p / parts, begin + len * (p + 1) / parts, size});
+            std::uint64_t depth = queue.size_approx();
+            if (depth > metrics.max_queue_depth.load(std::memory_order_relaxed))
+                metrics.max_queue_depth.store(depth, std::memory_order_relaxed);
+        }
+        metrics.files_queued.fetch_add(1, std::memory_order_relaxed);
+        metrics.tasks_queued.fetch_add(parts, std::memory_order_relaxed);
+        metrics.bytes_queued.fetch_add(len, std::memory_order_relaxed);
+    };
+    std::thread producer([&] {
+        source(enqueue);
+        metrics.walk_done = true;
+        queue.close();
+    });
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < a.threads; t++) {
+        workers.emplace_back([&, t] {
+            ThreadStats& stats = metrics.thread(t);
+            std::uint64_t started = metrics.elapsed_ns();
+            auto counter = make_counter(std::size_t(t));
+            std::unique_ptr<ChunkReader> reader = make_reader(a.io);
+            std::vector<std::string_view> words;
+            ChunkTask task;
+            while (queue.pop(task)) {
+                if (g_interrupted.load(std::memory_order_relaxed)) continue;
+                if (!index_chunk(task, a.minlen, *reader, counter, stats, words)) {
+                    int err = errno;
+                    std::cerr << "Cannot read " << task.path << ": " << error_text(err) << "\n";
+                }
+                ThreadStats::bump(stats.tasks, 1);
+                stats.wall_ns.store(metrics.elapsed_ns() - started, std::memory_order_relaxed);
+            }
+            StageClock clock(stats);
+            counter.finish();
+            clock.lap(Stage::Merge);
+            stats.wall_ns.store(metrics.elapsed_ns() - started, std::memory_order_relaxed);
+        });
+    }
+
+    producer.join();
+    for (std::thread& w : workers) w.join();
+    if (progress) progress->stop();
+}
+
+// Отчёт --stats-json; top_seconds — время отбора M лучших после подсчёта
+static bool write_stats(const Args& a, const Metrics& metrics, const char* mode, long long distinct,
+                        double top_seconds) {
+    if (a.stats_json.empty()) return true;
+    std::ofstream out(a.stats_json);
+    Metrics::Report report;
+    report.mode = mode;
+    report.io = io_mode_name(a.io);
+    report.distinct = distinct;
+    report.queue_capacity = kQueueCapacity;
+    report.top_seconds = top_seconds;
+    metrics.write_json(out, report);
+    out.close();
+    if (!out) {
+        std::cerr << "Cannot write " << a.stats_json << ": " << error_text(errno) << "\n";
+        return false;
+    }
+    return true;
+}
+
+static int run_exact(const Args& a, Metrics& metrics) {
+    ShardedIndex index;
+    run_workers(a, metrics, whole_files(a), [&] { return (long long)index.distinct(); },
+                [&](std::size_t t) { return ExactCounter(index, t); });
+    double started = metrics.elapsed();
+    std::vector<ShardedIndex::Entry> best = index.top(a.top, a.threads);
+    double top_seconds = metrics.elapsed() - started;
+    for (const auto& [word, count] : best) std::cout << word << " " << count << "\n";
+    return write_stats(a, metrics, "exact", (long long)index.distinct(), top_seconds) ? 0 : 1;
+}
+
+// Бюджет роста таблиц одного потока сверх пустых шардов (floor). Бюджет
+// проверяется после каждого блока чтения, а таблица при росте удваивается,
+// поэтому под рост отводится половина остатка доли потока. Лимит, при
+// котором остаток меньше самих пустых шардов, отвергается: иначе сброс шёл
+// бы после каждого блока мелкими прогонами.
+static bool spill_budget(const Args& a, std::size_t floor, std::size_t& budget) {
+    std::size_t share = std::size_t(a.mem_limit_mib << 20) / std::size_t(a.threads);
+    if (share < 3 * floor) {
+        std::size_t need = (3 * floor * std::size_t(a.threads) + (std::size_t(1) << 20) - 1) >> 20;
+        std::cerr << "--mem-limit " << a.mem_limit_mib << " MiB is too small for " << a.threads
+                  << " threads: empty word tables alone take " << (floor * std::size_t(a.threads) >> 10)
+                  << " KiB, use at least " << need << " MiB\n";
+        return false;
+    }
+    budget = (share - floor) / 2;
+    return true;
+}
+
+static int run_spill(const Args& a, Metrics& metrics) {
+    ShardedIndex shape;
+    std::size_t budget = 0;
+    if (!spill_budget(a, ShardedIndex::Local(shape).memory_bytes(), budget)) return 2;
+
+    std::error_code ec;
+    fs::path dir = a.tmp_dir.empty() ? fs::temp_directory_path(ec) : fs::path(a.tmp_dir);
+    std::unique_ptr<RunStore> store;
+    try {
+        store = std::make_unique<RunStore>(dir);
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "Cannot create spill directory: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::atomic<bool> failed{false};
+    run_workers(a, metrics, whole_files(a), nullptr, [&](std::size_t) { return SpillCounter(shape, *store, budget, failed); });
+
+    double started = metrics.elapsed();
+    std::vector<RunStore::Entry> best;
+    if (failed || !store->top(a.top, best)) {
+        std::cerr << "Spill merge failed: " << error_text(errno) << "\n";
+        return 1;
+    }
+    double top_seconds = metrics.elapsed() - started;
+    for (const auto& [word, count] : best) std::cout << word << " " << count << "\n";
+    return write_stats(a, metrics, "spill", (long long)store->distinct(), top_seconds) ? 0 : 1;
+}
+
+static int run_approx(const Args& a, Metrics& metrics) {
+    ApproxSummary summary;
+    run_workers(a, metrics, whole_files(a), nullptr, [&](std::size_t) { return ApproxCounter(a, summary); });
+    if (!summary.sketch) return write_stats(a, metrics, "approx", -1, 0) ? 0 : 1;
+    double started = metrics.elapsed();
+
+    // Оценка — меньшая из двух верхних границ; нижняя — из Space-Saving
+    struct Row {
+        std::string_view word;
+        std::uint64_t estimate;
+        std::uint64_t lower;
+    };
+    std::vector<Row> rows;
+    summary.heavy->for_each([&](const SpaceSaving::Entry& e) {
+        std::uint64_t estimate = std::min(e.count, summary.sketch->estimate(hash_word(e.word)));
+        rows.push_back(Row{e.word, estimate, e.count - e.error});
+    });
+    std::size_t m = std::min(a.top, rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + std::ptrdiff_t(m), rows.end(), [](const Row& x, const Row& y) {
+        return x.estimate != y.estimate ? x.estimate > y.estimate : x.word < y.word;
+    });
+
+    const CountMinSketch& cms = *summary.sketch;
+    std::uint64_t n = cms.total();
+    std::cout << "# approx: " << n << " words; count-min " << cms.depth() << "x" << cms.width()
+              << ": estimate - true <= " << std::uint64_t(std::ceil(cms.eps() * double(n)))
+              << " with probability " << std::setprecision(6) << 1.0 - cms.delta()
+              << "; space-saving k=" << summary.heavy->capacity()
+              << ": estimate - true <= " << n / summary.heavy->capacity() << "\n";
+    for (std::size_t i = 0; i < m; i++) std::cout << rows[i].word << " " << rows[i].estimate << " " << rows[i].lower << "\n";
+    // Различных слов приближённый режим не знает
+    return write_stats(a, metrics, "approx", -1, metrics.elapsed() - started) ? 0 : 1;
+}
+
+// Что делать с файлом каталога в режиме --index: разобрать [begin, size)
+struct IndexedFile {
+    FileStamp stamp;
+    std::string path;
+    std::uint64_t begin = 0;
+    bool touched = false;  // содержимое прежнее, сменился только mtime
+};
+
+// Сверяет каталог с сохранённым индексом. Файл с теми же размером и
+// mtime пропускается не читая. Иначе файл хешируется целиком (ContentHash),
+// и по пути берётся хеш его прежнего размера: совпал при том же размере —
+// файл только тронут, совпал у выросшего файла — файл дописан, и
+// разбирается только хвост с начала слова, на котором файл обрывался.
+// Прежняя частота этого недописанного слова попадает в minus. Если
+// какой-то файл исчез, не читается или изменён не дописыванием, вычесть
+// его вклад нельзя — false, индекс строится заново.
+static bool plan_index(const Args& a, const IndexFile* old, std::vector<IndexedFile>& plan,
+                       std::vector<std::string>& minus) {
+    std::unordered_map<std::string_view, const FileStamp*> known;
+    if (old) {
+        for (const FileStamp& f : old->files()) known.emplace(f.path, &f);
+    }
+    struct stat index_st;
+    bool have_index = ::stat(a.index.c_str(), &index_st) == 0;
+    std::size_t seen = 0;
+    bool consistent = true;
+
+    walk_files(a, [&](const fs::path& path, std::uint64_t) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (fd < 0 || ::fstat(fd, &st) != 0) {
+            std::cerr << "Cannot read " << path.string() << ": " << error_text(errno) << "\n";
+            if (fd >= 0) ::close(fd);
+            return;
+        }
+        // Сам индекс может лежать в индексируемом каталоге
+        if (have_index && st.st_dev == index_st.st_dev && st.st_ino == index_st.st_ino) {
+            ::close(fd);
+            return;
+        }
+        IndexedFile f;
+        f.path = path.string();
+        f.stamp.path = path.lexically_relative(a.path).string();
+        f.stamp.size = std::uint64_t(st.st_size);
+        f.stamp.mtime_ns = std::int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        bool ok = tail_start(fd, f.stamp.size, f.stamp.tail_start);
+
+        auto it = known.find(f.stamp.path);
+        const FileStamp* was = it != known.end() ? it->second : nullptr;
+        if (was) seen++;
+        if (ok && was && was->size == f.stamp.size && was->mtime_ns == f.stamp.mtime_ns) {
+            f.stamp.hash = was->hash;
+            f.begin = f.stamp.size;
+        } else if (ok) {
+            ContentHash hash;
+            std::uint64_t hashed = 0;
+            bool same_prefix = false;
+            if (was && was->size <= f.stamp.size) {
+                ok = hash_range(fd, 0, was->size, hash);
+                same_prefix = ok && hash.value() == was->hash;
+                hashed = was->size;
+            }
+            ok = ok && hash_range(fd, hashed, f.stamp.size, hash);
+            f.stamp.hash = hash.value();
+            if (ok && was && !same_prefix) {
+                consistent = false;
+            } else if (ok && was && was->size == f.stamp.size) {
+                f.begin = f.stamp.size;
+                f.touched = true;
+            } else if (ok && was) {
+                f.begin = was->tail_start;
+                std::string tail(std::size_t(was->size - was->tail_start), '\0');
+                if (::pread(fd, tail.data(), tail.size(), off_t(was->tail_start)) != ssize_t(tail.size())) {
+                    consistent = false;
+                } else if (tail.size() >= a.minlen) {
+                    for (char& c : tail) {
+                        if (c >= 'A' && c <= 'Z') c = char(c - 'A' + 'a');
+                    }
+                    minus.push_back(std::move(tail));
+                }
+            }
+        }
+        ::close(fd);
+        if (!ok) {
+            std::cerr << "Cannot read " << f.path << ": " << error_text(errno) << "\n";
+            // Старые частоты файла остались бы в индексе без его записи, и
+            // следующий запуск посчитал бы файл дважды
+            if (was) consistent = false;
+            return;
+        }
+        plan.push_back(std::move(f));
+    });
+    return consistent && seen == known.size();
+}
+
+// Режим --index: новые частоты сливаются с сохранёнными за один проход по
+// двум отсортированным спискам; по пути пишется новый индекс и
+// отбираются M лучших
+static int run_indexed(const Args& a, Metrics& metrics) {
+    std::signal(SIGINT, [](int) { g_interrupted = true; });
+    std::signal(SIGTERM, [](int) { g_interrupted = true; });
+
+    auto old = std::make_unique<IndexFile>();
+    if (!old->open(a.index)) {
+        if (errno != ENOENT)
+            std::cerr << "Cannot read index " << a.index << ": " << error_text(errno) << "; rebuilding\n";
+        old.reset();
+    } else if (old->minlen() != a.minlen) {
+        std::cerr << "Index " << a.index << " was built with --minlen " << old->minlen() << "; rebuilding\n";
+        old.reset();
+    }
+
+    std::vector<IndexedFile> plan;
+    std::vector<std::string> minus;
+    if (!plan_index(a, old.get(), plan, minus)) {
+        std::cerr << "Files were removed, unreadable or modified in place since the index was built; rebuilding\n";
+        old.reset();
+        minus.clear();
+        for (IndexedFile& f : plan) f.begin = 0;
+    }
+    std::size_t fresh = 0, grown = 0, touched = 0;
+    for (const IndexedFile& f : plan) {
+        if (f.begin == 0 && f.stamp.size > 0) fresh++;
+        else if (f.begin < f.stamp.size) grown++;
+        else if (f.touched) touched++;
+    }
+
+    ShardedIndex index;
+    auto source = [&](auto&& enqueue) {
+        for (const IndexedFile& f : plan) {
+            if (f.begin < f.stamp.size) enqueue(f.path, f.begin, f.stamp.size, f.stamp.size);
+        }
+    };
+    run_workers(a, metrics, source, [&] { return (long long)index.distinct(); },
+                [&](std::size_t t) { return ExactCounter(index, t); });
+    if (g_interrupted) {
+        std::cerr << "Interrupted; index " << a.index << " left unchanged\n";
+        return 130;
+    }
+
+    double started = metrics.elapsed();
+    std::vector<std::pair<std::string_view, std::uint64_t>> delta;
+    delta.reserve(index.distinct());
+    index.for_each([&](std::string_view word, std::uint64_t count) { delta.emplace_back(word, count); });
+    std::sort(delta.begin(), delta.end());
+    std::unordered_map<std::string_view, std::uint64_t> minus_counts;
+    for (const std::string& w : minus) minus_counts[w]++;
+
+    TopCollector<std::string> best(a.top);
+    std::size_t distinct = 0;
+    // Тронутые файлы тоже переписывают индекс: иначе их новый mtime не
+    // сохранится и каждый запуск будет хешировать их заново
+    bool changed = !old || fresh + grown + touched > 0 || plan.size() != old->files().size();
+    if (!changed) {
+        for (std::size_t i = 0; i < old->terms(); i++) best.offer(old->word(i), old->count(i));
+        distinct = old->terms();
+    } else {
+        std::vector<FileStamp> stamps;
+        for (IndexedFile& f : plan) stamps.push_back(std::move(f.stamp));
+        IndexWriter writer;
+        bool ok = writer.open(a.index, std::uint32_t(a.minlen), stamps);
+        auto emit = [&](std::string_view word, std::uint64_t count) {
+            auto it = minus_counts.find(word);
+            if (it != minus_counts.end()) count -= it->second;
+            if (count == 0) return;
+            best.offer(word, count);
+            ok = ok && writer.add(word, count);
+        };
+        std::size_t terms = old ? old->terms() : 0;
+        std::size_t i = 0, j = 0;
+        while (i < terms || j < delta.size()) {
+            if (j == delta.size() || (i < terms && old->word(i) < delta[j].first)) {
+                emit(old->word(i), old->count(i));
+                i++;
+            } else if (i == terms || delta[j].first < old->word(i)) {
+                emit(delta[j].first, delta[j].second);
+                j++;
+            } else {
+                emit(delta[j].first, old->count(i) + delta[j].second);
+                i++;
+                j++;
+            }
+        }
+        if (g_interrupted) {
+            std::cerr << "Interrupted; index " << a.index << " left unchanged\n";
+            return 130;
+        }
+        if (!ok || !writer.commit()) {
+            std::cerr << "Cannot write index " << a.index << ": " << error_text(errno) << "\n";
+            return 1;
+        }
+        distinct = writer.terms();
+    }
+    double top_seconds = metrics.elapsed() - started;
+
+    std::cerr << "index: " << plan.size() << " files, " << fresh << " new, " << grown << " appended, "
+              << plan.size() - fresh - grown << " unchanged\n";
+    for (const auto& [word, count] : best.take()) std::cout << word << " " << count << "\n";
+    return write_stats(a, metrics, "index", (long long)distinct, top_seconds) ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+
+    std::error_code ec;
+    if (!fs::is_directory(a.path, ec)) {
+        std::cerr << "Not a directory: " << a.path << "\n";
+        return 1;
+    }
+
+    Metrics metrics(a.threads);
+    if (!a.index.empty()) return run_indexed(a, metrics);
+    if (a.approx) return run_approx(a, metrics);
+    if (a.mem_limit_mib > 0) return run_spill(a, metrics);
+    return run_exact(a, metrics);
+}
@@ -0,0 +1,162 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+const char* stage_name(Stage stage) {
+    switch (stage) {
+    case Stage::Io: return "io";
+    case Stage::Tokenize: return "tokenize";
+    case Stage::Hash: return "hash";
+    case Stage::Merge: return "merge";
+    }
+    return "?";
+}
+
+Metrics::Metrics(int threads) : start_(std::chrono::steady_clock::now()), threads_(std::size_t(threads)) {}
+
+std::uint64_t Metrics::elapsed_ns() const {
+    return std::uint64_t(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+}
+
+double Metrics::elapsed() const { return double(elapsed_ns()) / 1e9; }
+
+Metrics::Totals Metrics::totals() const {
+    Totals t;
+    for (const ThreadStats& s : threads_) {
+        t.bytes += s.bytes.load(std::memory_order_relaxed);
+        t.tokens += s.tokens.load(std::memory_order_relaxed);
+        t.tasks += s.tasks.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kStages; i++) t.stage_ns[i] += s.stage_ns[i].load(std::memory_order_relaxed);
+    }
+    return t;
+}
+
+namespace {
+
+double seconds(std::uint64_t ns) { return double(ns) / 1e9; }
+
+double mib_per_second(std::uint64_t bytes, double seconds) {
+    return seconds > 0 ? double(bytes) / double(1 << 20) / seconds : 0.0;
+}
+
+// Число в формате 12.3M / 4.5k
+std::string short_count(double x) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (x >= 1e9) out << x / 1e9 << "G";
+    else if (x >= 1e6) out << x / 1e6 << "M";
+    else if (x >= 1e3) out << x / 1e3 << "k";
+    else out << std::setprecision(0) << x;
+    return out.str();
+}
+
+} // namespace
+
+void Metrics::write_json(std::ostream& out, const Report& report) const {
+    double elapsed_s = elapsed();
+    Totals t = totals();
+    out << std::fixed << std::setprecision(6);
+    out << "{\n"
+        << "  \"mode\": \"" << report.mode << "\",\n"
+        << "  \"io\": \"" << report.io << "\",\n"
+        << "  \"threads\": " << threads_.size() << ",\n"
+        << "  \"elapsed_s\": " << elapsed_s << ",\n"
+        << "  \"files\": " << files_queued.load() << ",\n"
+        << "  \"tasks\": " << t.tasks << ",\n"
+        << "  \"bytes\": " << t.bytes << ",\n"
+        << "  \"tokens\": " << t.tokens << ",\n"
+        << "  \"distinct\": ";
+    if (report.distinct < 0) out << "null";
+    else out << report.distinct;
+    out << ",\n"
+        << "  \"mib_per_s\": " << mib_per_second(t.bytes, elapsed_s) << ",\n"
+        << "  \"queue\": {\"capacity\": " << report.queue_capacity << ", \"max_depth\": " << max_queue_depth.load()
+        << "},\n"
+        << "  \"stages_s\": {";
+    for (std::size_t i = 0; i < kStages; i++)
+        out << "\"" << stage_name(Stage(i)) << "\": " << seconds(t.stage_ns[i]) << ", ";
+    out << "\"top\": " << report.top_seconds << "},\n"
+        << "  \"per_thread\": [\n";
+    for (std::size_t k = 0; k < threads_.size(); k++) {
+        const ThreadStats& s = threads_[k];
+        std::uint64_t busy = 0;
+        out << "    {\"thread\": " << k << ", \"tasks\": " << s.tasks.load() << ", \"bytes\": " << s.bytes.load()
+            << ", \"tokens\": " << s.tokens.load();
+        for (std::size_t i = 0; i < kStages; i++) {
+            std::uint64_t ns = s.stage_ns[i].load();
+            busy += ns;
+            out << ", \"" << stage_name(Stage(i)) << "_s\": " << seconds(ns);
+        }
+        std::uint64_t wall = s.wall_ns.load();
+        out << ", \"idle_s\": " << seconds(wall > busy ? wall - busy : 0)
+            << ", \"mib_per_s\": " << mib_per_second(s.bytes.load(), seconds(wall)) << "}"
+            << (k + 1 < threads_.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+ProgressLine::ProgressLine(const Metrics& metrics, std::function<std::size_t()> queue_depth,
+                           std::size_t queue_capacity, std::function<long long()> distinct)
+    : metrics_(metrics), queue_depth_(std::move(queue_depth)), queue_capacity_(queue_capacity),
+      distinct_(std::move(distinct)) {
+    thread_ = std::thread([this] { loop(); });
+}
+
+ProgressLine::~ProgressLine() { stop(); }
+
+void ProgressLine::stop() {
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (stop_) return;
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+    std::cerr << "\r\033[K" << std::flush;
+}
+
+void ProgressLine::loop() {
+    constexpr auto kInterval = std::chrono::milliseconds(250);
+    std::vector<std::uint64_t> last_bytes(std::size_t(metrics_.threads()), 0);
+    std::unique_lock<std::mutex> lock(lock_);
+    auto last = std::chrono::steady_clock::now();
+    while (!wake_.wait_for(lock, kInterval, [&] { return stop_; })) {
+        auto now = std::chrono::steady_clock::now();
+        draw(std::chrono::duration<double>(now - last).count(), last_bytes);
+        last = now;
+    }
+}
+
+void ProgressLine::draw(double interval, std::vector<std::uint64_t>& last_bytes) {
+    Metrics::Totals t = metrics_.totals();
+    double elapsed = metrics_.elapsed();
+    std::uint64_t queued = metrics_.bytes_queued.load(std::memory_order_relaxed);
+
+    // Скорость каждого потока за прошедший интервал
+    double slowest = 0, fastest = 0;
+    for (int k = 0; k < metrics_.threads(); k++) {
+        std::uint64_t bytes = metrics_.thread(k).bytes.load(std::memory_order_relaxed);
+        double rate = mib_per_second(bytes - last_bytes[std::size_t(k)], interval);
+        last_bytes[std::size_t(k)] = bytes;
+        slowest = k == 0 ? rate : std::min(slowest, rate);
+        fastest = std::max(fastest, rate);
+    }
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1);
+    if (queued > 0) line << std::setw(5) << 100.0 * double(t.bytes) / double(queued) << "%";
+    line << " " << double(t.bytes) / double(1 << 30) << "/" << double(queued) / double(1 << 30) << " GiB";
+    if (!metrics_.walk_done.load(std::memory_order_relaxed)) line << " (walking)";
+    line << "  " << mib_per_second(t.bytes, elapsed) << " MiB/s"
+         << "  tokens " << short_count(double(t.tokens));
+    long long distinct = distinct_ ? distinct_() : -1;
+    if (distinct >= 0) line << "  keys " << short_count(double(distinct));
+    line << "  queue " << queue_depth_() << "/" << queue_capacity_ << "  thread MiB/s " << std::setprecision(0)
+         << slowest << ".." << fastest;
+    std::cerr << "\r\033[K" << line.str() << std::flush;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Стадии работы потока; время между ними делится без пропусков
+enum class Stage { Io, Tokenize, Hash, Merge };
+constexpr std::size_t kStages = 4;
+
+const char* stage_name(Stage stage);
+
+// Счётчики одного рабочего потока, по кеш-линии на поток. Пишет только
+// владелец — обычными load + store без атомарных RMW, так что на горячем
+// пути это простые записи в свою линию. Читать можно из любого потока.
+struct alignas(64) ThreadStats {
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint64_t> tokens{0};
+    std::atomic<std::uint64_t> tasks{0};
+    std::atomic<std::uint64_t> stage_ns[kStages] = {};
+    std::atomic<std::uint64_t> wall_ns{0};  // с начала работы потока, обновляется в конце задачи
+
+    static void bump(std::atomic<std::uint64_t>& c, std::uint64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+// Замер подряд идущих стадий: lap записывает время с прошлого lap
+class StageClock {
+public:
+    explicit StageClock(ThreadStats& stats) : stats_(stats), last_(std::chrono::steady_clock::now()) {}
+
+    void lap(Stage stage) {
+        auto now = std::chrono::steady_clock::now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_).count();
+        ThreadStats::bump(stats_.stage_ns[std::size_t(stage)], std::uint64_t(ns));
+        last_ = now;
+    }
+
+private:
+    ThreadStats& stats_;
+    std::chrono::steady_clock::time_point last_;
+};
+
+// Метрики прогона: счётчики потоков и производителя, сводятся по запросу
+class Metrics {
+public:
+    explicit Metrics(int threads);
+
+    ThreadStats& thread(int t) { return threads_[std::size_t(t)]; }
+    const ThreadStats& thread(int t) const { return threads_[std::size_t(t)]; }
+    int threads() const { return int(threads_.size()); }
+
+    // Время с создания Metrics
+    double elapsed() const;
+    std::uint64_t elapsed_ns() const;
+
+    // Пишет только производитель
+    std::atomic<std::uint64_t> files_queued{0};
+    std::atomic<std::uint64_t> tasks_queued{0};
+    std::atomic<std::uint64_t> bytes_queued{0};
+    std::atomic<std::uint64_t> max_queue_depth{0};
+    std::atomic<bool> walk_done{false};
+
+    struct Totals {
+        std::uint64_t bytes = 0;
+        std::uint64_t tokens = 0;
+        std::uint64_t tasks = 0;
+        std::uint64_t stage_ns[kStages] = {};
+    };
+    Totals totals() const;
+
+    // Сведения, которых нет в счётчиках потоков; distinct < 0 — неизвестно
+    struct Report {
+        std::string mode;
+        std::string io;
+        long long distinct = -1;
+        std::size_t queue_capacity = 0;
+        double top_seconds = 0;
+    };
+    void write_json(std::ostream& out, const Report& report) const;
+
+private:
+    std::chrono::steady_clock::time_point start_;
+    std::vector<ThreadStats> threads_;
+};
+
+// Строка прогресса в stderr, перерисовывается раз в 250 мс через '\r':
+// доля прочитанного, скорость, слова, различные слова, глубина очереди и
+// разброс скорости потоков за последний интервал (отстающий поток видно
+// по минимуму).
+class ProgressLine {
+public:
+    ProgressLine(const Metrics& metrics, std::function<std::size_t()> queue_depth, std::size_t queue_capacity,
+                 std::function<long long()> distinct);
+    ~ProgressLine();
+
+    ProgressLine(const ProgressLine&) = delete;
+    ProgressLine& operator=(const ProgressLine&) = delete;
+
+    // Останавливает поток и стирает строку
+    void stop();
+
+private:
+    void loop();
+    void draw(double interval, std::vector<std::uint64_t>& last_bytes);
+
+    const Metrics& metrics_;
+    std::function<std::size_t()> queue_depth_;
+    std::size_t queue_capacity_;
+    std::function<long long()> distinct_;
+    std::mutex lock_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread thread_;
+};
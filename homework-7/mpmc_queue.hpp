@@ -0,0 +1,168 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Ограниченная очередь многих производителей и многих потребителей без
+// блокировок (схема Вьюкова): у каждой ячейки кольца свой счётчик seq,
+// по которому производитель и потребитель понимают, чья сейчас очередь
+// писать в ячейку. Захват позиции — один CAS на общем счётчике, сами данные
+// передаются через seq с release/acquire.
+//
+// Блокирующие push/pop не крутятся в цикле: на пустой (полной) очереди
+// поток засыпает в std::atomic::wait (futex в Linux) на счётчике событий.
+// notify вызывается, только если кто-то действительно спит (см. wake).
+//
+// close() — нормальное завершение: новые push отклоняются, pop отдаёт
+// оставшиеся элементы и затем возвращает false.
+template<class T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask_ = size - 1;
+        cells_.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; i++) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    bool try_push(T& value) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            std::size_t seq = cell.seq.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // ячейку ещё не освободил потребитель — очередь полна
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& value) {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            std::size_t seq = cell.seq.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // производитель ещё не записал ячейку — очередь пуста
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Ждёт свободного места; false, если очередь закрыта
+    bool push(T value) {
+        for (;;) {
+            if (closed_.load(std::memory_order_acquire)) return false;
+            if (try_push(value)) {
+                wake(pushed_, pop_sleeping_);
+                return true;
+            }
+            std::uint32_t seen = popped_.load(std::memory_order_seq_cst);
+            if (try_push(value)) {
+                wake(pushed_, pop_sleeping_);
+                return true;
+            }
+            sleep(popped_, push_sleeping_, seen);
+        }
+    }
+
+    // Ждёт элемента; false, если очередь закрыта и пуста
+    bool pop(T& value) {
+        for (;;) {
+            if (try_pop(value)) {
+                wake(popped_, push_sleeping_);
+                return true;
+            }
+            std::uint32_t seen = pushed_.load(std::memory_order_seq_cst);
+            if (try_pop(value)) {
+                wake(popped_, push_sleeping_);
+                return true;
+            }
+            // Очередь закрыта и пуста. Если какой-то push успел занять ячейку,
+            // но ещё не опубликовал её, он изменит pushed_ и разбудит нас.
+            if (closed_.load(std::memory_order_seq_cst) &&
+                tail_.load(std::memory_order_seq_cst) == head_.load(std::memory_order_seq_cst))
+                return false;
+            sleep(pushed_, pop_sleeping_, seen);
+        }
+    }
+
+    void close() {
+        closed_.store(true, std::memory_order_seq_cst);
+        pushed_.fetch_add(1, std::memory_order_seq_cst);
+        popped_.fetch_add(1, std::memory_order_seq_cst);
+        pushed_.notify_all();
+        popped_.notify_all();
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // Число элементов на момент чтения счётчиков — для метрик, не для логики
+    std::size_t size_approx() const {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        T value;
+    };
+
+    // Счётчик событий меняется до чтения числа спящих, а спящий увеличивает
+    // это число до wait: при seq_cst либо будящий увидит спящего и вызовет
+    // notify, либо wait увидит новый счётчик и сразу вернётся, так что
+    // пробуждение не теряется. Спящих считает каждый сам, будящий число не
+    // трогает: иначе поток, ещё не дошедший до futex, выпадал бы из счёта и
+    // следующие push не будили бы его. Событие — одна ячейка, поэтому
+    // достаточно notify_one.
+    static void wake(std::atomic<std::uint32_t>& events, std::atomic<std::uint32_t>& sleeping) {
+        events.fetch_add(1, std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_seq_cst) != 0) events.notify_one();
+    }
+
+    static void sleep(std::atomic<std::uint32_t>& events, std::atomic<std::uint32_t>& sleeping,
+                      std::uint32_t seen) {
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        events.wait(seen, std::memory_order_seq_cst);
+        sleeping.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    static constexpr std::size_t kLine = 64;
+
+    // Счётчики производителей и потребителей на разных кеш-линиях
+    alignas(kLine) std::atomic<std::size_t> tail_{0};
+    alignas(kLine) std::atomic<std::size_t> head_{0};
+    alignas(kLine) std::atomic<std::uint32_t> pushed_{0};
+    std::atomic<std::uint32_t> pop_sleeping_{0};   // потоков в sleep на pushed_
+    alignas(kLine) std::atomic<std::uint32_t> popped_{0};
+    std::atomic<std::uint32_t> push_sleeping_{0};  // потоков в sleep на popped_
+    alignas(kLine) std::atomic<bool> closed_{false};
+    std::size_t mask_ = 0;
+    std::unique_ptr<Cell[]> cells_;
+};
@@ -0,0 +1,177 @@
+// Сравнение очередей задач: MpmcQueue (без блокировок, сон на futex) и
+// классическая std::deque под std::mutex с двумя condition_variable.
+// T производителей и T потребителей передают поровну items целых чисел;
+// печатается пропускная способность в миллионах элементов в секунду.
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mpmc_queue.hpp"
+
+struct Args {
+    std::uint64_t items = 4000000;
+    std::size_t capacity = 1024;
+    int max_threads = 64;
+    int repeats = 3;
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options]\n"
+        "Options:\n"
+        "  --items N         items passed through the queue per run (default: 4000000)\n"
+        "  --capacity C      queue capacity (default: 1024)\n"
+        "  --max-threads T   largest producer/consumer count, doubled from 1 (default: 64)\n"
+        "  --repeats R       runs per measurement, median is reported (default: 3)\n";
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--items") {
+            a.items = std::stoull(need("--items"));
+        } else if (key == "--capacity") {
+            a.capacity = std::stoull(need("--capacity"));
+        } else if (key == "--max-threads") {
+            a.max_threads = std::stoi(need("--max-threads"));
+        } else if (key == "--repeats") {
+            a.repeats = std::max(1, std::stoi(need("--repeats")));
+        } else {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        }
+    }
+    return true;
+}
+
+// Та же семантика push/pop/close, что у MpmcQueue
+template<class T>
+class MutexQueue {
+public:
+    explicit MutexQueue(std::size_t capacity) : capacity_(capacity) {}
+
+    bool push(T value) {
+        std::unique_lock<std::mutex> lock(lock_);
+        not_full_.wait(lock, [&] { return closed_ || items_.size() < capacity_; });
+        if (closed_) return false;
+        items_.push_back(std::move(value));
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    bool pop(T& value) {
+        std::unique_lock<std::mutex> lock(lock_);
+        not_empty_.wait(lock, [&] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+        value = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+private:
+    std::mutex lock_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    std::size_t capacity_;
+    bool closed_ = false;
+};
+
+// Один прогон; возвращает секунды. Сумма принятых значений сверяется
+// с суммой отправленных, чтобы очередь не теряла и не дублировала элементы.
+template<class Queue>
+static double run_once(const Args& a, int threads) {
+    Queue queue(a.capacity);
+    std::uint64_t per_producer = a.items / std::uint64_t(threads);
+    std::vector<std::uint64_t> sums(std::size_t(threads), 0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            std::uint64_t v;
+            std::uint64_t sum = 0;
+            while (queue.pop(v)) sum += v;
+            sums[std::size_t(t)] = sum;
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; t++) {
+        producers.emplace_back([&] {
+            for (std::uint64_t i = 1; i <= per_producer; i++) queue.push(i);
+        });
+    }
+    for (std::thread& p : producers) p.join();
+    queue.close();
+    for (std::thread& c : pool) c.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t got = 0;
+    for (std::uint64_t s : sums) got += s;
+    std::uint64_t expected = std::uint64_t(threads) * per_producer * (per_producer + 1) / 2;
+    if (got != expected) {
+        std::cerr << "Queue lost or duplicated items: got sum " << got << ", expected " << expected << "\n";
+        std::exit(1);
+    }
+    return seconds;
+}
+
+template<class Queue>
+static double mitems_per_second(const Args& a, int threads) {
+    std::vector<double> times;
+    for (int r = 0; r < a.repeats; r++) times.push_back(run_once<Queue>(a, threads));
+    std::sort(times.begin(), times.end());
+    double items = double(a.items / std::uint64_t(threads) * std::uint64_t(threads));
+    return items / times[times.size() / 2] / 1e6;
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+
+    std::cout << "items " << a.items << ", capacity " << a.capacity
+              << ", hardware threads " << std::thread::hardware_concurrency() << "\n";
+    std::cout << std::left << std::setw(22) << "producers/consumers" << std::right
+              << std::setw(14) << "mpmc Mit/s" << std::setw(14) << "mutex Mit/s" << std::setw(10) << "ratio" << "\n";
+    for (int threads = 1; threads <= a.max_threads; threads *= 2) {
+        double mpmc = mitems_per_second<MpmcQueue<std::uint64_t>>(a, threads);
+        double mutex = mitems_per_second<MutexQueue<std::uint64_t>>(a, threads);
+        std::cout << std::left << std::setw(22) << (std::to_string(threads) + " / " + std::to_string(threads))
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << mpmc << std::setw(14) << mutex << std::setw(10) << mpmc / mutex << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "word_table.hpp"
+
+// Порядок вывода: по убыванию частоты, при равенстве по слову
+template<class Word>
+inline bool word_before(const std::pair<Word, std::uint64_t>& x, const std::pair<Word, std::uint64_t>& y) {
+    return x.second != y.second ? x.second > y.second : x.first < y.first;
+}
+
+// M лучших из потока пар (слово, частота): куча размера M, наверху худшее
+// из отобранных. Word — std::string_view или std::string; из string_view
+// строка делается, только если пара прошла в кучу.
+template<class Word>
+class TopCollector {
+public:
+    using Item = std::pair<Word, std::uint64_t>;
+
+    explicit TopCollector(std::size_t m) : m_(m) {}
+
+    template<class W>
+    void offer(const W& word, std::uint64_t count) {
+        if (m_ == 0) return;
+        if (heap_.size() < m_) {
+            heap_.emplace_back(Word(word), count);
+            std::push_heap(heap_.begin(), heap_.end(), before);
+        } else if (count > heap_.front().second ||
+                   (count == heap_.front().second && std::string_view(word) < std::string_view(heap_.front().first))) {
+            std::pop_heap(heap_.begin(), heap_.end(), before);
+            heap_.back() = Item(Word(word), count);
+            std::push_heap(heap_.begin(), heap_.end(), before);
+        }
+    }
+
+    // Отобранное по порядку вывода; коллектор после вызова пуст
+    std::vector<Item> take() {
+        std::sort_heap(heap_.begin(), heap_.end(), before);
+        return std::move(heap_);
+    }
+
+private:
+    static bool before(const Item& x, const Item& y) { return word_before(x, y); }
+
+    std::size_t m_;
+    std::vector<Item> heap_;
+};
+
+// Общий индекс, разбитый по старшим битам отпечатка слова на шарды со
+// своими mutex. Поток копит слова в ShardedIndex::Local, где шарды те же,
+// и сливает локальный шард в общий целиком (WordTable::merge): замок
+// берётся один раз на шард, а не на слово. Потоки начинают обход шардов
+// с разных мест и сначала пробуют try_lock, так что в конце работы они
+// почти не ждут друг друга.
+class ShardedIndex {
+public:
+    using Entry = std::pair<std::string, std::uint64_t>;
+
+    explicit ShardedIndex(unsigned shard_bits = 6)
+        : bits_(shard_bits), shards_(new Shard[std::size_t(1) << shard_bits]) {}
+
+    std::size_t shard_count() const { return std::size_t(1) << bits_; }
+
+    // Различных слов в общем индексе; во время слияний — приблизительно
+    std::size_t distinct() const { return distinct_.load(std::memory_order_relaxed); }
+
+    // Локальные таблицы потока, разложенные по тем же шардам
+    class Local {
+    public:
+        explicit Local(const ShardedIndex& index) : bits_(index.bits_) {
+            for (std::size_t i = 0; i < index.shard_count(); i++) tables_.emplace_back(256);
+        }
+
+        void add(std::string_view word) {
+            std::uint32_t fp = WordTable::fingerprint(word);
+            tables_[shard_of(fp, bits_)].add_hashed(fp, word);
+        }
+
+        // Число различных слов, ещё не слитых в общий индекс
+        std::size_t size() const {
+            std::size_t n = 0;
+            for (const WordTable& t : tables_) n += t.size();
+            return n;
+        }
+
+        std::size_t memory_bytes() const {
+            std::size_t n = 0;
+            for (const WordTable& t : tables_) n += t.memory_bytes();
+            return n;
+        }
+
+        // fn(std::string_view word, std::uint64_t count)
+        template<class Fn>
+        void for_each(Fn&& fn) const {
+            for (const WordTable& t : tables_) t.for_each(fn);
+        }
+
+        void clear() {
+            for (WordTable& t : tables_) t.clear();
+        }
+
+    private:
+        friend class ShardedIndex;
+        unsigned bits_;
+        std::vector<WordTable> tables_;
+    };
+
+    // start — с какого шарда начинать обход (обычно номер потока)
+    void merge(Local& local, std::size_t start = 0) {
+        std::size_t n = shard_count();
+        std::vector<char> done(n, 0);
+        std::size_t left = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            if (local.tables_[i].empty()) done[i] = 1;
+            else left++;
+        }
+        // Первый проход — только свободные шарды, дальше ждём занятые
+        for (bool blocking = false; left > 0; blocking = true) {
+            for (std::size_t k = 0; k < n; k++) {
+                std::size_t i = (start + k) & (n - 1);
+                if (done[i]) continue;
+                Shard& shard = shards_[i];
+                std::unique_lock<std::mutex> lock(shard.lock, std::defer_lock);
+                if (blocking) lock.lock();
+                else if (!lock.try_lock()) continue;
+                std::size_t before = shard.table.size();
+                shard.table.merge(local.tables_[i]);
+                distinct_.fetch_add(shard.table.size() - before, std::memory_order_relaxed);
+                done[i] = 1;
+                left--;
+            }
+        }
+    }
+
+    // fn(std::string_view word, std::uint64_t count) по всем словам;
+    // вызывать после того, как все потоки закончили merge
+    template<class Fn>
+    void for_each(Fn&& fn) const {
+        for (std::size_t i = 0; i < shard_count(); i++) shards_[i].table.for_each(fn);
+    }
+
+    // M самых частых. Каждый шард отбирает свои M кучей размера M
+    // (шарды делятся между threads потоками), затем отсортированные
+    // списки шардов сливаются k-путевым слиянием до первых M.
+    // Вызывать после того, как все потоки закончили merge.
+    std::vector<Entry> top(std::size_t m, int threads) const {
+        std::size_t n = shard_count();
+        std::vector<std::vector<std::pair<std::string_view, std::uint64_t>>> best(n);
+        std::atomic<std::size_t> next{0};
+        auto work = [&] {
+            for (;;) {
+                std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= n) break;
+                best[i] = shard_top(shards_[i].table, m);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < std::min<int>(threads, int(n)); t++) pool.emplace_back(work);
+        work();
+        for (std::thread& t : pool) t.join();
+
+        // Голова каждого списка в куче; наверху — лучшая
+        using Head = std::pair<std::size_t, std::size_t>;  // шард, позиция
+        auto worse = [&](const Head& x, const Head& y) { return word_before(best[y.first][y.second], best[x.first][x.second]); };
+        std::priority_queue<Head, std::vector<Head>, decltype(worse)> heads(worse);
+        for (std::size_t i = 0; i < n; i++) {
+            if (!best[i].empty()) heads.push({i, 0});
+        }
+        std::vector<Entry> result;
+        while (result.size() < m && !heads.empty()) {
+            auto [i, pos] = heads.top();
+            heads.pop();
+            result.emplace_back(std::string(best[i][pos].first), best[i][pos].second);
+            if (pos + 1 < best[i].size()) heads.push({i, pos + 1});
+        }
+        return result;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::mutex lock;
+        WordTable table;
+    };
+
+    // Старшие биты отпечатка: младшие задают позицию внутри WordTable
+    static std::size_t shard_of(std::uint32_t fp, unsigned bits) { return bits == 0 ? 0 : fp >> (32 - bits); }
+
+    // M лучших слов шарда по убыванию
+    static std::vector<std::pair<std::string_view, std::uint64_t>> shard_top(const WordTable& table, std::size_t m) {
+        TopCollector<std::string_view> best(m);
+        table.for_each([&](std::string_view word, std::uint64_t count) { best.offer(word, count); });
+        return best.take();
+    }
+
+    unsigned bits_;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<std::size_t> distinct_{0};
+};
@@ -0,0 +1,223 @@
+#include "spill.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <system_error>
+
+#include <unistd.h>
+
+#include "sharded_index.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Буфер на каждый открытый прогон; при слиянии их kFanIn, так что
+// слияние укладывается в kFanIn * kBuffer = 8 MiB
+constexpr std::size_t kBuffer = std::size_t(128) << 10;
+constexpr std::size_t kFanIn = 64;
+
+// Буферизованная запись прогона
+class RunWriter {
+public:
+    bool open(const std::string& path) {
+        out_.open(path, std::ios::binary | std::ios::trunc);
+        buf_.reserve(kBuffer);
+        return bool(out_);
+    }
+
+    void write(std::string_view word, std::uint64_t count) {
+        std::uint32_t len = std::uint32_t(word.size());
+        if (buf_.size() + sizeof(len) + word.size() + sizeof(count) > kBuffer) flush();
+        append(&len, sizeof(len));
+        append(word.data(), word.size());
+        append(&count, sizeof(count));
+    }
+
+    bool close() {
+        flush();
+        out_.close();
+        return !out_.fail();
+    }
+
+    std::uint64_t bytes() const { return bytes_; }
+
+private:
+    void append(const void* p, std::size_t n) {
+        const char* c = static_cast<const char*>(p);
+        buf_.insert(buf_.end(), c, c + n);
+    }
+
+    void flush() {
+        out_.write(buf_.data(), std::streamsize(buf_.size()));
+        bytes_ += buf_.size();
+        buf_.clear();
+    }
+
+    std::ofstream out_;
+    std::vector<char> buf_;
+    std::uint64_t bytes_ = 0;
+};
+
+// Последовательное чтение прогона. word() указывает в буфер и живёт до next().
+class RunReader {
+public:
+    bool open(const std::string& path) {
+        in_.open(path, std::ios::binary);
+        buf_.resize(kBuffer);
+        return bool(in_);
+    }
+
+    // false — прогон кончился или повреждён (failed())
+    bool next() {
+        std::uint32_t len;
+        if (!ensure(sizeof(len))) return false;
+        std::memcpy(&len, buf_.data() + pos_, sizeof(len));
+        if (!ensure(sizeof(len) + len + sizeof(count_))) {
+            failed_ = true;
+            return false;
+        }
+        word_ = std::string_view(buf_.data() + pos_ + sizeof(len), len);
+        std::memcpy(&count_, buf_.data() + pos_ + sizeof(len) + len, sizeof(count_));
+        pos_ += sizeof(len) + len + sizeof(count_);
+        return true;
+    }
+
+    std::string_view word() const { return word_; }
+    std::uint64_t count() const { return count_; }
+    bool failed() const { return failed_ || in_.bad(); }
+
+private:
+    // n байт от pos_ в буфере; непрочитанный хвост переносится в начало
+    bool ensure(std::size_t n) {
+        if (end_ - pos_ >= n) return true;
+        std::memmove(buf_.data(), buf_.data() + pos_, end_ - pos_);
+        end_ -= pos_;
+        pos_ = 0;
+        if (buf_.size() < n) buf_.resize(std::max(n, buf_.size() * 2));
+        while (end_ < n && in_) {
+            in_.read(buf_.data() + end_, std::streamsize(buf_.size() - end_));
+            end_ += std::size_t(in_.gcount());
+        }
+        return end_ >= n;
+    }
+
+    std::ifstream in_;
+    std::vector<char> buf_;
+    std::size_t pos_ = 0;
+    std::size_t end_ = 0;
+    std::string_view word_;
+    std::uint64_t count_ = 0;
+    bool failed_ = false;
+};
+
+// k-путевое слияние: sink(std::string_view word, std::uint64_t total) по
+// возрастанию слова, частоты одного слова из разных прогонов сложены
+template<class Sink>
+bool merge_runs(const std::vector<std::string>& paths, Sink&& sink) {
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for (const std::string& path : paths) {
+        readers.push_back(std::make_unique<RunReader>());
+        if (!readers.back()->open(path)) return false;
+    }
+    auto after = [&](std::size_t x, std::size_t y) { return readers[y]->word() < readers[x]->word(); };
+    std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(after)> heads(after);
+    for (std::size_t i = 0; i < readers.size(); i++) {
+        if (readers[i]->next()) heads.push(i);
+        else if (readers[i]->failed()) return false;
+    }
+
+    std::string word;
+    while (!heads.empty()) {
+        std::size_t i = heads.top();
+        word.assign(readers[i]->word());
+        std::uint64_t total = 0;
+        while (!heads.empty() && readers[heads.top()]->word() == word) {
+            std::size_t j = heads.top();
+            heads.pop();
+            total += readers[j]->count();
+            if (readers[j]->next()) heads.push(j);
+            else if (readers[j]->failed()) return false;
+        }
+        sink(std::string_view(word), total);
+    }
+    return true;
+}
+
+} // namespace
+
+RunStore::RunStore(fs::path dir) : dir_(std::move(dir)) {
+    dir_ /= "indexer-" + std::to_string(::getpid());
+    fs::create_directories(dir_);
+}
+
+RunStore::~RunStore() {
+    std::error_code ec;
+    for (const std::string& path : created_) fs::remove(path, ec);
+    fs::remove(dir_, ec);
+}
+
+fs::path RunStore::next_path() {
+    std::lock_guard<std::mutex> guard(lock_);
+    fs::path path = dir_ / ("run-" + std::to_string(next_id_++) + ".bin");
+    created_.push_back(path.string());
+    return path;
+}
+
+bool RunStore::write_run(std::vector<std::pair<std::string_view, std::uint64_t>>& words) {
+    std::sort(words.begin(), words.end());
+    fs::path path = next_path();
+    RunWriter writer;
+    if (!writer.open(path.string())) return false;
+    for (const auto& [word, count] : words) writer.write(word, count);
+    if (!writer.close()) return false;
+
+    std::lock_guard<std::mutex> guard(lock_);
+    runs_.push_back(path.string());
+    bytes_written_ += writer.bytes();
+    return true;
+}
+
+bool RunStore::merge_group(const std::vector<std::string>& inputs, const std::string& output) {
+    RunWriter writer;
+    if (!writer.open(output)) return false;
+    bool ok = merge_runs(inputs, [&](std::string_view word, std::uint64_t count) { writer.write(word, count); });
+    ok = writer.close() && ok;
+    bytes_written_ += writer.bytes();
+    std::error_code ec;
+    for (const std::string& path : inputs) fs::remove(path, ec);
+    return ok;
+}
+
+bool RunStore::top(std::size_t m, std::vector<Entry>& result) {
+    // Лишние прогоны сливаются группами по kFanIn, пока не поместятся разом
+    while (runs_.size() > kFanIn) {
+        std::vector<std::string> merged;
+        for (std::size_t i = 0; i < runs_.size(); i += kFanIn) {
+            std::vector<std::string> group(runs_.begin() + std::ptrdiff_t(i),
+                                           runs_.begin() + std::ptrdiff_t(std::min(runs_.size(), i + kFanIn)));
+            if (group.size() == 1) {
+                merged.push_back(group[0]);
+                continue;
+            }
+            std::string output = next_path().string();
+            if (!merge_group(group, output)) return false;
+            merged.push_back(output);
+        }
+        runs_.swap(merged);
+    }
+
+    TopCollector<std::string> best(m);
+    distinct_ = 0;
+    auto sink = [&](std::string_view word, std::uint64_t count) {
+        best.offer(word, count);
+        distinct_++;
+    };
+    if (!merge_runs(runs_, sink)) return false;
+    result = best.take();
+    return true;
+}
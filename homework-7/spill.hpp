@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Частичные подсчёты на диске для режима с ограничением памяти.
+// Поток, чья таблица переросла бюджет, сортирует её по слову и пишет
+// отдельным файлом-прогоном (run); в конце прогоны сливаются потоково
+// k-путевым слиянием, равные слова суммируются, и по пути отбираются
+// M самых частых. В памяти одновременно — только буферы чтения прогонов.
+//
+// Формат прогона: записи [u32 длина][байты слова][u64 частота] по
+// возрастанию слова, в порядке байт машины (файлы временные).
+class RunStore {
+public:
+    using Entry = std::pair<std::string, std::uint64_t>;
+
+    // Прогоны кладутся в dir; файлы удаляются в деструкторе
+    explicit RunStore(std::filesystem::path dir);
+    ~RunStore();
+
+    RunStore(const RunStore&) = delete;
+    RunStore& operator=(const RunStore&) = delete;
+
+    // Сортирует words по слову и записывает прогоном; потокобезопасно.
+    // false — ошибка записи (errno).
+    bool write_run(std::vector<std::pair<std::string_view, std::uint64_t>>& words);
+
+    // Сливает все прогоны и возвращает M самых частых. Если прогонов больше,
+    // чем можно открыть разом, они сначала сливаются группами в новые.
+    // Вызывать после того, как все потоки закончили запись.
+    bool top(std::size_t m, std::vector<Entry>& result);
+
+    std::size_t runs() const { return runs_.size(); }
+    std::uint64_t bytes_written() const { return bytes_written_; }
+    // Различных слов; известно после top()
+    std::uint64_t distinct() const { return distinct_; }
+
+private:
+    std::filesystem::path next_path();
+    bool merge_group(const std::vector<std::string>& inputs, const std::string& output);
+
+    std::filesystem::path dir_;
+    std::mutex lock_;
+    std::vector<std::string> runs_;
+    std::vector<std::string> created_;
+    std::uint64_t next_id_ = 0;
+    std::uint64_t bytes_written_ = 0;
+    std::uint64_t distinct_ = 0;
+};
@@ -0,0 +1,508 @@
+// Сравнение стратегий синхронизации общего счётчика слов. Один и тот же
+// корпус (log_generator с фиксированными seed, словарём и скосом)
+// целиком лежит в памяти и разбирается K потоками: поток берёт следующий
+// файл, токенизирует его и считает слова выбранной стратегией.
+//
+//   global-mutex   одна таблица под одним mutex, замок на каждое слово
+//   local-merge    своя таблица на файл, слияние в общую под mutex
+//   sharded-mutex  64 шарда со своими mutex, замок шарда на каждое слово
+//   lock-free      64 шарда открытой адресации, слот занимается CAS,
+//                  счётчик — fetch_add; размер задаётся заранее
+//
+// Во всех стратегиях с mutex таблица — WordTable, так что разница между
+// ними — только в синхронизации. Результат каждой стратегии сверяется с
+// однопоточным подсчётом. Выход — CSV: пропускная способность,
+// эффективность масштабирования (скорость на K потоков против скорости
+// на наименьшем K, делённая на отношение K) и пиковый RSS прогона —
+// каждая точка (стратегия, K) идёт в своём процессе.
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <malloc.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "tokenizer.hpp"
+#include "word_table.hpp"
+
+namespace fs = std::filesystem;
+
+struct Args {
+    std::string generator;  // пусто — log_generator рядом с бенчмарком
+    std::string corpus_dir = "sync_bench_corpus";
+    int files = 16;
+    int mib = 4;
+    int vocab = 50000;
+    std::uint64_t seed = 42;
+    std::vector<int> threads = {1, 2, 4, 8};
+    std::vector<double> skews = {0.8, 1.2, 1.6};
+    std::vector<std::string> strategies;  // пусто — все
+    int repeats = 3;
+};
+
+static const char* const kStrategies[] = {"global-mutex", "local-merge", "sharded-mutex", "lock-free"};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options]\n"
+        "Runs one generated corpus through several word-count synchronization strategies\n"
+        "and prints CSV: throughput, scaling efficiency and peak RSS per run.\n"
+        "Options:\n"
+        "  --generator PATH  log_generator executable (default: next to this binary)\n"
+        "  --corpus DIR      where generated corpora are kept and reused (default: sync_bench_corpus)\n"
+        "  --files N         files per corpus (default: 16)\n"
+        "  --mib SIZE        MiB per file (default: 4)\n"
+        "  --vocab V         vocabulary size (default: 50000)\n"
+        "  --seed X          generator seed (default: 42)\n"
+        "  --threads LIST    comma-separated thread counts (default: 1,2,4,8)\n"
+        "  --skew LIST       comma-separated generator skews (default: 0.8,1.2,1.6)\n"
+        "  --strategy LIST   global-mutex,local-merge,sharded-mutex,lock-free (default: all)\n"
+        "  --repeats R       runs per point, median time is reported (default: 3)\n"
+        "\nExample:\n"
+        "  " << prog << " --threads 1,2,4,8,16 --skew 0,1.2 > sync.csv\n";
+}
+
+static std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> items;
+    std::stringstream in(s);
+    for (std::string item; std::getline(in, item, ',');) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--generator") {
+            a.generator = need("--generator");
+        } else if (key == "--corpus") {
+            a.corpus_dir = need("--corpus");
+        } else if (key == "--files") {
+            a.files = std::max(1, std::stoi(need("--files")));
+        } else if (key == "--mib") {
+            a.mib = std::max(1, std::stoi(need("--mib")));
+        } else if (key == "--vocab") {
+            a.vocab = std::max(1, std::stoi(need("--vocab")));
+        } else if (key == "--seed") {
+            a.seed = std::stoull(need("--seed"));
+        } else if (key == "--threads") {
+            a.threads.clear();
+            for (const std::string& t : split_list(need("--threads"))) a.threads.push_back(std::max(1, std::stoi(t)));
+        } else if (key == "--skew") {
+            a.skews.clear();
+            for (const std::string& s : split_list(need("--skew"))) a.skews.push_back(std::stod(s));
+        } else if (key == "--strategy") {
+            a.strategies = split_list(need("--strategy"));
+        } else if (key == "--repeats") {
+            a.repeats = std::max(1, std::stoi(need("--repeats")));
+        } else {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        }
+    }
+    if (a.strategies.empty()) a.strategies.assign(std::begin(kStrategies), std::end(kStrategies));
+    for (const std::string& s : a.strategies) {
+        if (std::find(std::begin(kStrategies), std::end(kStrategies), s) == std::end(kStrategies)) {
+            std::cerr << "Unknown strategy: " << s << "\n";
+            std::exit(2);
+        }
+    }
+    if (a.threads.empty() || a.skews.empty()) {
+        std::cerr << "threads/skew lists must not be empty\n";
+        std::exit(2);
+    }
+    std::sort(a.threads.begin(), a.threads.end());
+    return true;
+}
+
+// Корпус в памяти; файлы уже приведены к нижнему регистру одним проходом
+// токенизатора, так что замеры не зависят от первого прохода
+struct Corpus {
+    std::vector<std::string> files;
+    std::uint64_t bytes = 0;
+    std::uint64_t words = 0;
+};
+
+// Корпус для скоса skew: генерируется один раз в свой подкаталог
+static bool load_corpus(const Args& a, const std::string& generator, double skew, Corpus& corpus) {
+    std::ostringstream name;
+    name << "f" << a.files << "-m" << a.mib << "-v" << a.vocab << "-s" << skew << "-x" << a.seed;
+    fs::path dir = fs::path(a.corpus_dir) / name.str();
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) {
+        std::ostringstream cmd;
+        cmd << "\"" << generator << "\" --out \"" << dir.string() << "\" --files " << a.files << " --mib " << a.mib
+            << " --vocab " << a.vocab << " --skew " << skew << " --seed " << a.seed << " > /dev/null";
+        std::cerr << "generating " << dir.string() << "\n";
+        if (std::system(cmd.str().c_str()) != 0) {
+            std::cerr << "Generator failed: " << cmd.str() << "\n";
+            fs::remove_all(dir, ec);
+            return false;
+        }
+    }
+
+    std::vector<fs::path> paths;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file()) paths.push_back(entry.path());
+    }
+    std::sort(paths.begin(), paths.end());
+    for (const fs::path& path : paths) {
+        std::ifstream in(path, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        for_each_word(text.data(), text.size(), 1, [&](std::string_view) { corpus.words++; });
+        corpus.bytes += text.size();
+        corpus.files.push_back(std::move(text));
+    }
+    return !corpus.files.empty();
+}
+
+// Потоки разбирают файлы корпуса по одному: fn(номер потока, файл)
+template<class Fn>
+static void for_files(Corpus& corpus, int threads, Fn&& fn) {
+    std::atomic<std::size_t> next{0};
+    auto work = [&](int t) {
+        for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < corpus.files.size();)
+            fn(t, corpus.files[i]);
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(work, t);
+    work(0);
+    for (std::thread& t : pool) t.join();
+}
+
+// Сводка подсчёта для сверки: число различных слов, всех слов и сумма
+// hash(слово) * частота, не зависящая от порядка обхода
+struct Digest {
+    std::uint64_t distinct = 0;
+    std::uint64_t total = 0;
+    std::uint64_t checksum = 0;
+
+    void add(std::string_view word, std::uint64_t count) {
+        distinct++;
+        total += count;
+        checksum += hash_word(word) * count;
+    }
+
+    bool operator==(const Digest& o) const {
+        return distinct == o.distinct && total == o.total && checksum == o.checksum;
+    }
+};
+
+constexpr unsigned kShardBits = 6;
+constexpr std::size_t kShards = std::size_t(1) << kShardBits;
+
+static Digest run_global_mutex(Corpus& corpus, int threads) {
+    std::mutex lock;
+    WordTable table;
+    for_files(corpus, threads, [&](int, std::string& file) {
+        for_each_word(file.data(), file.size(), 1, [&](std::string_view w) {
+            std::lock_guard<std::mutex> guard(lock);
+            table.add(w);
+        });
+    });
+    Digest d;
+    table.for_each([&](std::string_view w, std::uint64_t n) { d.add(w, n); });
+    return d;
+}
+
+static Digest run_local_merge(Corpus& corpus, int threads) {
+    std::mutex lock;
+    WordTable table;
+    for_files(corpus, threads, [&](int, std::string& file) {
+        WordTable local;
+        for_each_word(file.data(), file.size(), 1, [&](std::string_view w) { local.add(w); });
+        std::lock_guard<std::mutex> guard(lock);
+        table.merge(local);
+    });
+    Digest d;
+    table.for_each([&](std::string_view w, std::uint64_t n) { d.add(w, n); });
+    return d;
+}
+
+static Digest run_sharded_mutex(Corpus& corpus, int threads) {
+    struct alignas(64) Shard {
+        std::mutex lock;
+        WordTable table;
+    };
+    std::unique_ptr<Shard[]> shards(new Shard[kShards]);
+    for_files(corpus, threads, [&](int, std::string& file) {
+        for_each_word(file.data(), file.size(), 1, [&](std::string_view w) {
+            std::uint32_t fp = WordTable::fingerprint(w);
+            Shard& shard = shards[fp >> (32 - kShardBits)];
+            std::lock_guard<std::mutex> guard(shard.lock);
+            shard.table.add_hashed(fp, w);
+        });
+    });
+    Digest d;
+    for (std::size_t i = 0; i < kShards; i++) shards[i].table.for_each([&](std::string_view w, std::uint64_t n) {
+        d.add(w, n);
+    });
+    return d;
+}
+
+// Таблица открытой адресации без замков. Слот занимается CAS пустой →
+// занят, владелец копирует ключ в свою арену и публикует слот меткой
+// hash | готов (release); остальные, встретив занятый слот, ждут
+// публикации. Частота растёт через fetch_add. Таблица не растёт:
+// ёмкость задаётся по известному числу различных слов.
+class LockFreeTable {
+public:
+    explicit LockFreeTable(std::size_t capacity) {
+        std::size_t n = 64;
+        while (n < capacity) n <<= 1;
+        slots_.reset(new Slot[n]);
+        mask_ = n - 1;
+    }
+
+    bool add(std::string_view word, std::uint64_t hash, WordArena& arena) {
+        const std::uint64_t ready = hash | kReady;
+        std::size_t i = std::size_t(hash) & mask_;
+        for (std::size_t probes = 0; probes <= mask_; i = (i + 1) & mask_, probes++) {
+            Slot& s = slots_[i];
+            std::uint64_t tag = s.tag.load(std::memory_order_acquire);
+            if (tag == kEmpty) {
+                if (s.tag.compare_exchange_strong(tag, kBusy, std::memory_order_acquire)) {
+                    s.key = arena.store(word);
+                    s.len = std::uint32_t(word.size());
+                    s.count.store(1, std::memory_order_relaxed);
+                    s.tag.store(ready, std::memory_order_release);
+                    return true;
+                }
+            }
+            while (tag == kBusy) tag = s.tag.load(std::memory_order_acquire);
+            if (tag == ready && s.len == word.size() && std::memcmp(s.key, word.data(), word.size()) == 0) {
+                s.count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;  // таблица переполнена
+    }
+
+    // fn(std::string_view word, std::uint64_t count); после всех add
+    template<class Fn>
+    void for_each(Fn&& fn) const {
+        for (std::size_t i = 0; i <= mask_; i++) {
+            const Slot& s = slots_[i];
+            if (s.tag.load(std::memory_order_acquire) & kReady)
+                fn(std::string_view(s.key, s.len), s.count.load(std::memory_order_relaxed));
+        }
+    }
+
+private:
+    static constexpr std::uint64_t kEmpty = 0;
+    static constexpr std::uint64_t kBusy = 1;
+    static constexpr std::uint64_t kReady = std::uint64_t(1) << 63;
+
+    struct Slot {
+        std::atomic<std::uint64_t> tag{kEmpty};
+        std::atomic<std::uint64_t> count{0};
+        const char* key = nullptr;
+        std::uint32_t len = 0;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_ = 0;
+};
+
+static Digest run_lock_free(Corpus& corpus, int threads, std::uint64_t distinct) {
+    std::vector<std::unique_ptr<LockFreeTable>> shards;
+    // Запас вдвое с лишним: шарды заполняются неравномерно
+    for (std::size_t i = 0; i < kShards; i++)
+        shards.push_back(std::make_unique<LockFreeTable>(std::size_t(distinct) * 5 / 2 / kShards));
+    std::vector<WordArena> arenas{std::size_t(threads)};
+    std::atomic<bool> overflow{false};
+    for_files(corpus, threads, [&](int t, std::string& file) {
+        WordArena& arena = arenas[std::size_t(t)];
+        for_each_word(file.data(), file.size(), 1, [&](std::string_view w) {
+            std::uint64_t hash = hash_word(w);
+            if (!shards[hash >> (64 - kShardBits)]->add(w, hash, arena)) overflow = true;
+        });
+    });
+    Digest d;
+    if (overflow) return d;
+    for (const auto& shard : shards) shard->for_each([&](std::string_view w, std::uint64_t n) { d.add(w, n); });
+    return d;
+}
+
+static double status_mib(const char* field) {
+    std::ifstream in("/proc/self/status");
+    std::string line;
+    std::size_t n = std::strlen(field);
+    while (std::getline(in, line)) {
+        if (line.compare(0, n, field) == 0 && line.size() > n && line[n] == ':')
+            return std::strtod(line.c_str() + n + 1, nullptr) / 1024.0;  // в kB
+    }
+    return 0;
+}
+
+// Замеры одной точки (стратегия, потоки): времена повторов, RSS в начале
+// и пик за все повторы
+struct Point {
+    std::vector<double> times;
+    double base = 0;
+    double peak = 0;
+    bool ok = true;
+};
+
+static Point measure(const Args& a, const std::string& strategy, Corpus& corpus, int threads,
+                     const Digest& expected) {
+    Point p;
+    p.base = status_mib("VmRSS");
+    for (int r = 0; r < a.repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        Digest got;
+        if (strategy == "global-mutex") got = run_global_mutex(corpus, threads);
+        else if (strategy == "local-merge") got = run_local_merge(corpus, threads);
+        else if (strategy == "sharded-mutex") got = run_sharded_mutex(corpus, threads);
+        else got = run_lock_free(corpus, threads, expected.distinct);
+        p.times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        p.ok = p.ok && got == expected;
+    }
+    p.peak = status_mib("VmHWM");
+    return p;
+}
+
+// Каждая точка считается в отдельном дочернем процессе: у него свой VmHWM,
+// и память, оставшаяся в куче после прошлых стратегий, не попадает ни в
+// базу, ни в пик следующих. Корпус и эталон достаются ребёнку от fork без
+// копирования. Результат передаётся по pipe: base, peak, ok, времена.
+static bool measure_isolated(const Args& a, const std::string& strategy, Corpus& corpus, int threads,
+                             const Digest& expected, Point& p) {
+    int fds[2];
+    if (::pipe(fds) != 0) return false;
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        int err = errno;
+        ::close(fds[0]);
+        ::close(fds[1]);
+        errno = err;
+        return false;
+    }
+    if (pid == 0) {
+        ::close(fds[0]);
+        Point got = measure(a, strategy, corpus, threads, expected);
+        std::vector<double> out = {got.base, got.peak, got.ok ? 1.0 : 0.0};
+        out.insert(out.end(), got.times.begin(), got.times.end());
+        const char* data = reinterpret_cast<const char*>(out.data());
+        std::size_t left = out.size() * sizeof(double);
+        while (left > 0) {
+            ssize_t n = ::write(fds[1], data, left);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) ::_exit(1);
+            data += n;
+            left -= std::size_t(n);
+        }
+        ::_exit(0);
+    }
+    ::close(fds[1]);
+    std::vector<double> in(3 + std::size_t(a.repeats));
+    char* data = reinterpret_cast<char*>(in.data());
+    std::size_t want = in.size() * sizeof(double), got = 0;
+    while (got < want) {
+        ssize_t n = ::read(fds[0], data + got, want - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        got += std::size_t(n);
+    }
+    int err = errno;
+    ::close(fds[0]);
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (got < want || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        errno = got < want && err ? err : ECHILD;
+        return false;
+    }
+    p.base = in[0];
+    p.peak = in[1];
+    p.ok = in[2] != 0;
+    p.times.assign(in.begin() + 3, in.end());
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+    std::string generator = a.generator;
+    if (generator.empty()) generator = (fs::absolute(argv[0]).parent_path() / "log_generator").string();
+
+    std::cout << "strategy,skew,threads,seconds,mib_per_s,mwords_per_s,efficiency,peak_rss_mib,base_rss_mib,"
+                 "extra_rss_mib,distinct,ok\n";
+    bool all_ok = true;
+    for (double skew : a.skews) {
+        Corpus corpus;
+        if (!load_corpus(a, generator, skew, corpus)) return 1;
+
+        // Эталон — однопоточный подсчёт в одной таблице
+        Digest expected;
+        {
+            WordTable table;
+            for (std::string& file : corpus.files)
+                for_each_word(file.data(), file.size(), 1, [&](std::string_view w) { table.add(w); });
+            table.for_each([&](std::string_view w, std::uint64_t n) { expected.add(w, n); });
+        }
+        // Память таблицы эталона — системе, иначе она войдёт в базу RSS
+        // каждого дочернего процесса
+        ::malloc_trim(0);
+
+        for (const std::string& strategy : a.strategies) {
+            double base_rate = 0;
+            int base_threads = 0;
+            for (int threads : a.threads) {
+                Point p;
+                if (!measure_isolated(a, strategy, corpus, threads, expected, p)) {
+                    std::cerr << "Cannot measure " << strategy << " on " << threads
+                              << " threads: " << std::strerror(errno) << "\n";
+                    return 1;
+                }
+                std::sort(p.times.begin(), p.times.end());
+                double seconds = p.times[p.times.size() / 2];
+                double rate = double(corpus.bytes) / double(1 << 20) / seconds;
+                if (base_threads == 0) {
+                    base_rate = rate;
+                    base_threads = threads;
+                }
+                double efficiency = rate / base_rate / (double(threads) / double(base_threads));
+                all_ok = all_ok && p.ok;
+                std::ostringstream row;
+                row << strategy << "," << skew << "," << threads << "," << std::fixed << std::setprecision(4)
+                    << seconds << "," << std::setprecision(1) << rate << "," << std::setprecision(2)
+                    << double(corpus.words) / seconds / 1e6 << "," << efficiency << "," << std::setprecision(1)
+                    << p.peak << "," << p.base << "," << p.peak - p.base << "," << expected.distinct << ","
+                    << (p.ok ? "yes" : "no") << "\n";
+                std::cout << row.str() << std::flush;
+            }
+        }
+    }
+    if (!all_ok) std::cerr << "Some strategies disagree with the single-threaded count\n";
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Символ слова: [A-Za-z0-9_]
+inline bool is_word_char(unsigned char c) {
+    static constexpr auto table = [] {
+        std::array<bool, 256> t{};
+        for (int c = 0; c < 256; c++)
+            t[c] = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        return t;
+    }();
+    return table[c];
+}
+
+// Побайтовый вариант: эталон для векторного и запасной путь без AVX2
+template<class Fn>
+void for_each_word_scalar(char* data, std::size_t size, std::size_t minlen, Fn&& fn) {
+    std::size_t i = 0;
+    while (i < size) {
+        while (i < size && !is_word_char(static_cast<unsigned char>(data[i]))) i++;
+        std::size_t start = i;
+        for (; i < size && is_word_char(static_cast<unsigned char>(data[i])); i++) {
+            if (data[i] >= 'A' && data[i] <= 'Z') data[i] = char(data[i] - 'A' + 'a');
+        }
+        if (i - start >= minlen && i > start) fn(std::string_view(data + start, i - start));
+    }
+}
+
+#if defined(__AVX2__)
+namespace tokenizer_detail {
+
+// Классификация 32 байт двумя pshufb по полубайтам: байт — символ слова,
+// если у таблиц младшего и старшего полубайта есть общий бит.
+//   бит 1: '0'-'9' (0x30-0x39)
+//   бит 2: 'A'-'O', 'a'-'o' (0x41-0x4F, 0x61-0x6F)
+//   бит 4: 'P'-'Z', 'p'-'z' (0x50-0x5A, 0x70-0x7A)
+//   бит 8: '_' (0x5F)
+// Байты >= 0x80 получают старший полубайт 8..F, где таблица нулевая.
+// Заодно прибавляет 0x20 к 'A'-'Z' и пишет блок обратно, если там были
+// заглавные. Возвращает маску символов слова.
+inline std::uint32_t classify_lower32(char* p) {
+    const __m256i lo_table = _mm256_setr_epi8(
+        5, 7, 7, 7, 7, 7, 7, 7, 7, 7, 6, 2, 2, 2, 2, 10,
+        5, 7, 7, 7, 7, 7, 7, 7, 7, 7, 6, 2, 2, 2, 2, 10);
+    const __m256i hi_table = _mm256_setr_epi8(
+        0, 0, 0, 1, 2, 12, 2, 4, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 1, 2, 12, 2, 4, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i lo = _mm256_shuffle_epi8(lo_table, _mm256_and_si256(v, nibble));
+    __m256i hi = _mm256_shuffle_epi8(hi_table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    __m256i word = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256());
+
+    // 'A'-'Z' сдвигаются в -128..-103: одно знаковое сравнение на диапазон
+    __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8(char(0x80 - 'A')));
+    __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(char(0x80 + 26)), shifted);
+    if (!_mm256_testz_si256(upper, upper)) {
+        v = _mm256_add_epi8(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(word));
+}
+
+} // namespace tokenizer_detail
+#endif
+
+// Разбивает data[0, size) на слова, приводит их к нижнему регистру прямо
+// в буфере и передаёт fn(std::string_view) каждое слово длиной >= minlen.
+// string_view указывает в data и живёт, пока жив буфер.
+//
+// С AVX2 буфер идёт блоками по 64 байта: маска символов слова, границы
+// слов — переходы 0/1 в маске, которые ищутся через tzcnt. Хвост короче
+// 64 байт копируется в блок, добитый разделителями, и записывается обратно.
+template<class Fn>
+void for_each_word(char* data, std::size_t size, std::size_t minlen, Fn&& fn) {
+#if defined(__AVX2__)
+    using tokenizer_detail::classify_lower32;
+    bool in_word = false;
+    std::size_t start = 0;
+
+    // Переходы в маске блока, начинающегося с base
+    auto scan = [&](std::uint64_t mask, std::size_t base) {
+        std::uint64_t from = ~std::uint64_t(0);
+        for (;;) {
+            std::uint64_t t = (in_word ? ~mask : mask) & from;
+            if (t == 0) break;
+            unsigned k = unsigned(__builtin_ctzll(t));
+            if (in_word) {
+                std::size_t end = base + k;
+                if (end - start >= minlen) fn(std::string_view(data + start, end - start));
+            } else {
+                start = base + k;
+            }
+            in_word = !in_word;
+            from = ~std::uint64_t(0) << k;
+        }
+    };
+
+    std::size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        std::uint64_t mask = std::uint64_t(classify_lower32(data + i)) |
+                             (std::uint64_t(classify_lower32(data + i + 32)) << 32);
+        scan(mask, i);
+    }
+    if (i < size) {
+        // Слово из хвоста закроется первым байтом добивки, а string_view
+        // должен указывать в data, поэтому хвост сначала пишется обратно.
+        alignas(32) char tail[64];
+        std::size_t n = size - i;
+        std::memcpy(tail, data + i, n);
+        std::memset(tail + n, ' ', sizeof(tail) - n);
+        std::uint64_t mask = std::uint64_t(classify_lower32(tail)) |
+                             (std::uint64_t(classify_lower32(tail + 32)) << 32);
+        std::memcpy(data + i, tail, n);
+        scan(mask, i);
+    } else if (in_word && size - start >= minlen) {
+        fn(std::string_view(data + start, size - start));
+    }
+#else
+    for_each_word_scalar(data, size, minlen, fn);
+#endif
+}
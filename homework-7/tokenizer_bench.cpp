@@ -0,0 +1,214 @@
+// Скорость токенизатора: побайтовый for_each_word_scalar против
+// for_each_word (AVX2, если собран с ним). Вход — файл или случайный
+// лог-подобный текст; перед замером оба варианта сверяются на нём и на
+// случайных байтах всех 256 значений.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tokenizer.hpp"
+
+struct Args {
+    std::string file;
+    std::size_t mib = 64;
+    std::size_t minlen = 1;
+    int repeats = 5;
+    std::uint64_t seed = 1;
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options]\n"
+        "Options:\n"
+        "  --file F          tokenize file F instead of generated text\n"
+        "  --mib N           size of generated text in MiB (default: 64)\n"
+        "  --minlen L        minimal word length (default: 1)\n"
+        "  --repeats R       runs per measurement, median is reported (default: 5)\n"
+        "  --seed X          seed for generated text (default: 1)\n";
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--file") {
+            a.file = need("--file");
+        } else if (key == "--mib") {
+            a.mib = std::stoull(need("--mib"));
+        } else if (key == "--minlen") {
+            a.minlen = std::max<std::size_t>(1, std::stoull(need("--minlen")));
+        } else if (key == "--repeats") {
+            a.repeats = std::max(1, std::stoi(need("--repeats")));
+        } else if (key == "--seed") {
+            a.seed = std::stoull(need("--seed"));
+        } else {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        }
+    }
+    return true;
+}
+
+// Строки вида "1700000123 | INFO : ip=10.2.3.4 code=404 Word_12 /api/v1/x?id=7 user_42"
+static std::string generate_text(std::size_t bytes, std::uint64_t seed) {
+    static const char* punct[] = {" ", " ", " ", " - ", " | ", " : ", " :: ", ", ", "; ", "/", "?id=", "="};
+    static const char* levels[] = {"INFO", "WARN", "ERROR", "DEBUG"};
+    std::mt19937_64 rng(seed);
+    std::string text;
+    text.reserve(bytes + 256);
+    while (text.size() < bytes) {
+        text += std::to_string(1700000000 + rng() % 100000);
+        text += punct[rng() % 12];
+        text += levels[rng() % 4];
+        int words = 6 + int(rng() % 12);
+        for (int w = 0; w < words; w++) {
+            text += punct[rng() % 12];
+            int len = 2 + int(rng() % 10);
+            for (int c = 0; c < len; c++) {
+                std::uint64_t r = rng() % 40;
+                text += r < 26 ? char('a' + r) : r < 30 ? char('A' + r - 26) : r < 39 ? char('0' + r - 30) : '_';
+            }
+        }
+        text += '\n';
+    }
+    text.resize(bytes);
+    return text;
+}
+
+// Число слов и хеш их последовательности: сравнение без хранения токенов
+struct Digest {
+    std::uint64_t words = 0;
+    std::uint64_t hash = 0;
+
+    void add(std::string_view w) {
+        words++;
+        hash = hash * 1000003 ^ std::hash<std::string_view>{}(w);
+    }
+    bool operator==(const Digest& o) const { return words == o.words && hash == o.hash; }
+};
+
+template<class Tokenize>
+static Digest digest(std::string text, std::size_t minlen, Tokenize tokenize, std::string* lowered = nullptr) {
+    Digest d;
+    tokenize(text.data(), text.size(), minlen, [&](std::string_view w) { d.add(w); });
+    if (lowered) *lowered = std::move(text);
+    return d;
+}
+
+static auto scalar = [](char* data, std::size_t size, std::size_t minlen, auto&& fn) {
+    for_each_word_scalar(data, size, minlen, fn);
+};
+static auto vectorized = [](char* data, std::size_t size, std::size_t minlen, auto&& fn) {
+    for_each_word(data, size, minlen, fn);
+};
+
+static bool same_result(const std::string& text, std::size_t minlen) {
+    std::string a, b;
+    Digest da = digest(text, minlen, scalar, &a);
+    Digest db = digest(text, minlen, vectorized, &b);
+    return da == db && a == b;
+}
+
+// Все длины 0..200, все смещения хвоста и произвольные байты 0..255
+static bool self_check(std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    for (int round = 0; round < 2000; round++) {
+        std::size_t len = std::size_t(round % 201);
+        std::string text(len, ' ');
+        int alphabet = round % 3;
+        for (char& c : text) {
+            std::uint64_t r = rng();
+            if (alphabet == 0) c = char(r & 0xFF);
+            else if (alphabet == 1) c = "aZ_9 .\x80\xff"[r % 8];
+            else c = r % 7 == 0 ? ' ' : char('A' + r % 58);
+        }
+        for (std::size_t minlen : {1, 2, 5}) {
+            if (!same_result(text, minlen)) return false;
+        }
+    }
+    return true;
+}
+
+// В замере на слово только счётчик и первый байт, чтобы мерить сам разбор.
+// Запись в volatile не даёт компилятору выбросить обработку слов.
+static volatile std::uint64_t g_sink;
+
+template<class Tokenize>
+static double mib_per_second(const std::string& text, const Args& a, Tokenize tokenize, std::uint64_t& words) {
+    std::vector<double> times;
+    for (int r = 0; r < a.repeats; r++) {
+        std::string copy = text;  // регистр меняется на месте, каждый прогон — с исходного текста
+        std::uint64_t count = 0, sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        tokenize(copy.data(), copy.size(), a.minlen, [&](std::string_view w) {
+            count++;
+            sink += std::uint64_t(static_cast<unsigned char>(w[0])) + w.size();
+        });
+        times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        g_sink = sink;
+        words = count;
+    }
+    std::sort(times.begin(), times.end());
+    return double(text.size()) / double(1 << 20) / times[times.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+
+    if (!self_check(a.seed)) {
+        std::cerr << "Vectorized tokenizer disagrees with the scalar one on random input\n";
+        return 1;
+    }
+
+    std::string text;
+    if (!a.file.empty()) {
+        std::ifstream in(a.file, std::ios::binary);
+        if (!in) {
+            std::cerr << "Cannot open " << a.file << "\n";
+            return 1;
+        }
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    } else {
+        text = generate_text(a.mib << 20, a.seed);
+    }
+    if (!same_result(text, a.minlen)) {
+        std::cerr << "Vectorized tokenizer disagrees with the scalar one\n";
+        return 1;
+    }
+
+#if defined(__AVX2__)
+    const char* kind = "avx2";
+#else
+    const char* kind = "scalar fallback";
+#endif
+    std::uint64_t words = 0;
+    double s = mib_per_second(text, a, scalar, words);
+    double v = mib_per_second(text, a, vectorized, words);
+    std::cout << "input " << text.size() << " bytes, " << words << " words, for_each_word: " << kind << "\n"
+              << std::fixed << std::setprecision(1)
+              << std::left << std::setw(16) << "scalar" << std::right << std::setw(10) << s << " MiB/s\n"
+              << std::left << std::setw(16) << "for_each_word" << std::right << std::setw(10) << v << " MiB/s"
+              << "  x" << std::setprecision(2) << v / s << "\n";
+    return 0;
+}
@@ -0,0 +1,255 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Хеш слова: по 8 байт за шаг, умножение и xor-сдвиг
+inline std::uint64_t hash_word(std::string_view s) {
+    constexpr std::uint64_t k = 0x9E3779B97F4A7C15ull;
+    const char* p = s.data();
+    std::size_t n = s.size();
+    std::uint64_t h = std::uint64_t(n) * k;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t v;
+        std::memcpy(&v, p + i, 8);
+        h = (h ^ v) * k;
+        h ^= h >> 29;
+    }
+    if (i < n) {
+        std::uint64_t v = 0;
+        std::memcpy(&v, p + i, n - i);
+        h = (h ^ v) * k;
+    }
+    h ^= h >> 32;
+    h *= k;
+    return h ^ (h >> 29);
+}
+
+// Bump-аллокатор для длинных ключей, освобождается целиком. Блоки растут
+// от 4 до 64 KiB: у потока таблица на каждый шард, и полный блок на первое
+// же длинное слово шарда раздувал бы пустые таблицы.
+class WordArena {
+public:
+    const char* store(std::string_view s) {
+        if (left_ < s.size()) {
+            std::size_t size = std::max(std::min(kMaxBlock, std::max(kMinBlock, bytes_)), s.size());
+            blocks_.emplace_back(new char[size]);
+            cur_ = blocks_.back().get();
+            left_ = size;
+            bytes_ += size;
+        }
+        char* p = cur_;
+        std::memcpy(p, s.data(), s.size());
+        cur_ += s.size();
+        left_ -= s.size();
+        return p;
+    }
+
+    // Забирает блоки другой арены: её указатели остаются живыми
+    void absorb(WordArena& other) {
+        for (auto& b : other.blocks_) blocks_.push_back(std::move(b));
+        bytes_ += other.bytes_;
+        other.blocks_.clear();
+        other.cur_ = nullptr;
+        other.left_ = 0;
+        other.bytes_ = 0;
+    }
+
+    void clear() {
+        blocks_.clear();
+        cur_ = nullptr;
+        left_ = 0;
+        bytes_ = 0;
+    }
+
+    std::size_t bytes() const { return bytes_; }
+
+private:
+    static constexpr std::size_t kMinBlock = std::size_t(4) << 10;
+    static constexpr std::size_t kMaxBlock = std::size_t(64) << 10;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cur_ = nullptr;
+    std::size_t left_ = 0;
+    std::size_t bytes_ = 0;
+};
+
+// Счётчик слов с открытой адресацией (линейное пробирование).
+// Слот — 32 байта, два на кеш-линию: 32-битный отпечаток хеша, длина,
+// 16 байт ключа и счётчик. Ключ до 15 байт лежит прямо в слоте, длиннее —
+// в арене таблицы, а в слоте указатель. Поиск сравнивает отпечаток и длину
+// и только при совпадении идёт в байты ключа, так что промах почти никогда
+// не трогает память за пределами слота. Отпечаток заодно задаёт позицию,
+// поэтому рост таблицы и слияние не пересчитывают хеши.
+class WordTable {
+public:
+    explicit WordTable(std::size_t capacity = 1024) : initial_(capacity) { allocate(capacity); }
+
+    WordTable(const WordTable&) = delete;
+    WordTable& operator=(const WordTable&) = delete;
+    WordTable(WordTable&&) = default;
+    WordTable& operator=(WordTable&&) = default;
+
+    // Отпечаток, по которому слово кладётся в таблицу. Снаружи нужен,
+    // чтобы по тем же битам выбирать шард (см. ShardedIndex).
+    static std::uint32_t fingerprint(std::string_view word) {
+        std::uint64_t h = hash_word(word);
+        return std::uint32_t(h ^ (h >> 32));
+    }
+
+    void add(std::string_view word, std::uint64_t n = 1) { add_hashed(fingerprint(word), word, n); }
+
+    // fp обязан быть fingerprint(word)
+    void add_hashed(std::uint32_t fp, std::string_view word, std::uint64_t n = 1) {
+        Slot& s = find_slot(fp, word);
+        if (s.len != 0) {
+            s.count += n;
+            return;
+        }
+        if ((size_ + 1) * 4 > capacity() * 3) {  // заполнение до 3/4
+            grow(capacity() * 2);
+            add_hashed(fp, word, n);
+            return;
+        }
+        s.hash = fp;
+        s.len = std::uint32_t(word.size());
+        if (word.size() <= kInline) std::memcpy(s.key_data.bytes, word.data(), word.size());
+        else s.key_data.ptr = arena_.store(word);
+        s.count = n;
+        size_++;
+    }
+
+    // Переносит все слова other в эту таблицу и очищает other.
+    // Хеши берутся из слотов, длинные ключи не копируются: арена other
+    // целиком переходит к этой таблице.
+    void merge(WordTable& other) {
+        if (size_ == 0) {
+            swap(other);
+            other.clear();
+            return;
+        }
+        arena_.absorb(other.arena_);
+        reserve(size_ + other.size_);
+        for (std::size_t i = 0; i <= other.mask_; i++) {
+            const Slot& s = other.slots_[i];
+            if (s.len == 0) continue;
+            Slot& dst = find_slot(s.hash, s.key());
+            if (dst.len == 0) {
+                dst = s;
+                size_++;
+            } else {
+                dst.count += s.count;
+            }
+        }
+        other.clear();
+    }
+
+    std::uint64_t count(std::string_view word) const {
+        std::uint32_t fp = fingerprint(word);
+        for (std::size_t i = fp & mask_;; i = (i + 1) & mask_) {
+            const Slot& s = slots_[i];
+            if (s.len == 0) return 0;
+            if (s.hash == fp && s.key() == word) return s.count;
+        }
+    }
+
+    // fn(std::string_view word, std::uint64_t count) для каждого слова
+    template<class Fn>
+    void for_each(Fn&& fn) const {
+        for (std::size_t i = 0; i <= mask_; i++) {
+            const Slot& s = slots_[i];
+            if (s.len != 0) fn(s.key(), s.count);
+        }
+    }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::size_t capacity() const { return mask_ + 1; }
+
+    // Память под слоты и арену
+    std::size_t memory_bytes() const { return capacity() * sizeof(Slot) + arena_.bytes(); }
+
+    // Возвращает таблицу к начальной ёмкости
+    void clear() {
+        allocate(initial_);
+        arena_.clear();
+    }
+
+    void swap(WordTable& other) {
+        std::swap(slots_, other.slots_);
+        std::swap(mask_, other.mask_);
+        std::swap(size_, other.size_);
+        std::swap(arena_, other.arena_);
+        std::swap(initial_, other.initial_);
+    }
+
+private:
+    static constexpr std::uint32_t kInline = 15;
+
+    struct Slot {
+        std::uint32_t hash;
+        std::uint32_t len;  // 0 — пустой слот: слов нулевой длины не бывает
+        union {
+            char bytes[16];
+            const char* ptr;
+        } key_data;
+        std::uint64_t count;
+
+        std::string_view key() const {
+            return std::string_view(len <= kInline ? key_data.bytes : key_data.ptr, len);
+        }
+    };
+    static_assert(sizeof(Slot) == 32, "two slots per cache line");
+
+    void allocate(std::size_t capacity) {
+        std::size_t size = 16;
+        while (size < capacity) size <<= 1;
+        slots_.reset(new Slot[size]());
+        mask_ = size - 1;
+        size_ = 0;
+    }
+
+    // Слот со словом или пустой слот, куда его можно положить
+    Slot& find_slot(std::uint32_t fp, std::string_view word) {
+        for (std::size_t i = fp & mask_;; i = (i + 1) & mask_) {
+            Slot& s = slots_[i];
+            if (s.len == 0) return s;
+            if (s.hash == fp && s.len == word.size() &&
+                std::memcmp(s.len <= kInline ? s.key_data.bytes : s.key_data.ptr, word.data(), word.size()) == 0)
+                return s;
+        }
+    }
+
+    void reserve(std::size_t words) {
+        std::size_t need = capacity();
+        while (words * 4 > need * 3) need *= 2;
+        if (need != capacity()) grow(need);
+    }
+
+    // Перекладывает слоты в таблицу нового размера по сохранённым хешам
+    void grow(std::size_t capacity) {
+        std::unique_ptr<Slot[]> old = std::move(slots_);
+        std::size_t old_size = mask_ + 1;
+        std::size_t words = size_;
+        allocate(capacity);
+        for (std::size_t i = 0; i < old_size; i++) {
+            const Slot& s = old[i];
+            if (s.len == 0) continue;
+            std::size_t j = s.hash & mask_;
+            while (slots_[j].len != 0) j = (j + 1) & mask_;
+            slots_[j] = s;
+        }
+        size_ = words;
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_ = 0;
+    std::size_t size_ = 0;
+    WordArena arena_;
+    std::size_t initial_;
+};
@@ -0,0 +1,230 @@
+// Счётчик слов: std::unordered_map<std::string, uint64_t> против WordTable.
+// Поток слов похож на вывод generator.cpp: словарь со скошенными частотами,
+// суффиксы _1234 и user_<id>, дающие миллионы различных ключей.
+// Замеряются подсчёт всех слов и слияние parts локальных таблиц в одну.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "word_table.hpp"
+
+struct Args {
+    std::size_t words = 20000000;
+    int vocab = 50000;
+    double skew = 1.2;
+    int parts = 8;
+    int repeats = 3;
+    std::uint64_t seed = 1;
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options]\n"
+        "Options:\n"
+        "  --words N         words in the stream (default: 20000000)\n"
+        "  --vocab V         base vocabulary size (default: 50000)\n"
+        "  --skew S          frequency skew of the vocabulary (default: 1.2)\n"
+        "  --parts P         local tables merged in the merge test (default: 8)\n"
+        "  --repeats R       runs per measurement, median is reported (default: 3)\n"
+        "  --seed X          random seed (default: 1)\n";
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--words") {
+            a.words = std::stoull(need("--words"));
+        } else if (key == "--vocab") {
+            a.vocab = std::max(1, std::stoi(need("--vocab")));
+        } else if (key == "--skew") {
+            a.skew = std::stod(need("--skew"));
+        } else if (key == "--parts") {
+            a.parts = std::max(1, std::stoi(need("--parts")));
+        } else if (key == "--repeats") {
+            a.repeats = std::max(1, std::stoi(need("--repeats")));
+        } else if (key == "--seed") {
+            a.seed = std::stoull(need("--seed"));
+        } else {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        }
+    }
+    return true;
+}
+
+// Слова лежат подряд в text, words — string_view в него, как их отдаёт токенизатор
+struct WordStream {
+    std::string text;
+    std::vector<std::string_view> words;
+};
+
+static WordStream make_stream(const Args& a) {
+    std::mt19937_64 rng(a.seed);
+    std::vector<std::string> vocab;
+    for (int i = 0; i < a.vocab; i++) {
+        std::string w(3 + rng() % 10, 'a');
+        for (char& c : w) c = char('a' + rng() % 26);
+        vocab.push_back(w);
+    }
+    std::vector<double> weights;
+    for (int i = 0; i < a.vocab; i++) weights.push_back(1.0 / std::pow(double(i + 1), a.skew));
+    std::discrete_distribution<int> pick(weights.begin(), weights.end());
+
+    WordStream s;
+    std::vector<std::size_t> ends;
+    for (std::size_t i = 0; i < a.words; i++) {
+        std::uint64_t r = rng() % 100;
+        if (r < 10) {
+            s.text += "user_" + std::to_string(1 + rng() % 2000000);
+        } else {
+            s.text += vocab[std::size_t(pick(rng))];
+            if (r < 20) s.text += "_" + std::to_string(rng() % 10000);
+        }
+        ends.push_back(s.text.size());
+    }
+    std::size_t begin = 0;
+    for (std::size_t end : ends) {
+        s.words.emplace_back(s.text.data() + begin, end - begin);
+        begin = end;
+    }
+    return s;
+}
+
+struct WordHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+using StdCounts = std::unordered_map<std::string, std::uint64_t, WordHash, std::equal_to<>>;
+
+static void std_add(StdCounts& counts, std::string_view w, std::uint64_t n = 1) {
+    auto it = counts.find(w);
+    if (it != counts.end()) it->second += n;
+    else counts.emplace(std::string(w), n);
+}
+
+template<class Fn>
+static double median_seconds(int repeats, Fn&& fn) {
+    std::vector<double> times;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+
+    WordStream stream = make_stream(a);
+    const auto& words = stream.words;
+    std::size_t part = (words.size() + std::size_t(a.parts) - 1) / std::size_t(a.parts);
+
+    // Подсчёт
+    StdCounts std_counts;
+    WordTable table;
+    double std_count = median_seconds(a.repeats, [&] {
+        std_counts = StdCounts();
+        for (std::string_view w : words) std_add(std_counts, w);
+    });
+    double table_count = median_seconds(a.repeats, [&] {
+        table = WordTable();
+        for (std::string_view w : words) table.add(w);
+    });
+
+    auto part_range = [&](int p, auto&& fn) {
+        std::size_t begin = std::min(words.size(), std::size_t(p) * part);
+        std::size_t end = std::min(words.size(), begin + part);
+        for (std::size_t i = begin; i < end; i++) fn(words[i]);
+    };
+    auto same_counts = [&](const WordTable& t, const StdCounts& counts) {
+        if (t.size() != std_counts.size() || counts.size() != std_counts.size()) return false;
+        for (const auto& [w, n] : std_counts) {
+            auto it = counts.find(w);
+            if (t.count(w) != n || it == counts.end() || it->second != n) return false;
+        }
+        return true;
+    };
+    if (!same_counts(table, std_counts)) {
+        std::cerr << "WordTable disagrees with std::unordered_map\n";
+        return 1;
+    }
+
+    StdCounts std_merged;
+    // Слияние: parts локальных таблиц по куску потока в одну общую,
+    // замеряется только само слияние
+    double std_merge_only = 0, table_merge_only = 0;
+    {
+        std::vector<double> std_times, table_times;
+        for (int r = 0; r < a.repeats; r++) {
+            std::vector<StdCounts> std_locals(std::size_t(a.parts));
+            std::vector<WordTable> table_locals(std::size_t(a.parts));
+            for (int p = 0; p < a.parts; p++) {
+                part_range(p, [&](std::string_view w) {
+                    std_add(std_locals[std::size_t(p)], w);
+                    table_locals[std::size_t(p)].add(w);
+                });
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            std_merged = StdCounts();
+            for (StdCounts& local : std_locals) {
+                for (auto& [w, n] : local) std_add(std_merged, w, n);
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            WordTable merged;
+            for (WordTable& local : table_locals) merged.merge(local);
+            auto t2 = std::chrono::steady_clock::now();
+            std_times.push_back(std::chrono::duration<double>(t1 - t0).count());
+            table_times.push_back(std::chrono::duration<double>(t2 - t1).count());
+            if (r + 1 == a.repeats) table = std::move(merged);
+        }
+        std::sort(std_times.begin(), std_times.end());
+        std::sort(table_times.begin(), table_times.end());
+        std_merge_only = std_times[std_times.size() / 2];
+        table_merge_only = table_times[table_times.size() / 2];
+    }
+
+    if (!same_counts(table, std_merged)) {
+        std::cerr << "Merged tables disagree\n";
+        return 1;
+    }
+
+    std::cout << "words " << words.size() << ", distinct " << std_counts.size()
+              << ", table memory " << table.memory_bytes() / (1 << 20) << " MiB\n"
+              << std::left << std::setw(22) << "" << std::right << std::setw(14) << "unordered_map"
+              << std::setw(14) << "WordTable" << std::setw(10) << "ratio" << "\n"
+              << std::fixed << std::setprecision(1)
+              << std::left << std::setw(22) << "count, Mwords/s" << std::right
+              << std::setw(14) << double(words.size()) / std_count / 1e6
+              << std::setw(14) << double(words.size()) / table_count / 1e6
+              << std::setw(10) << std::setprecision(2) << std_count / table_count << "\n"
+              << std::setprecision(1)
+              << std::left << std::setw(22) << ("merge x" + std::to_string(a.parts) + ", ms") << std::right
+              << std::setw(14) << std_merge_only * 1e3 << std::setw(14) << table_merge_only * 1e3
+              << std::setw(10) << std::setprecision(2) << std_merge_only / table_merge_only << "\n";
+    return 0;
+}